@@ -0,0 +1,129 @@
+// 日志写入基准: 对比逐行log_write与log_writer批量写入的吞吐
+// 使用 make bench 编译，日志写入到 SE_DIR（基准编译时重定向到 /tmp/se_boot_bench）
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "se-boot-src/path.h"
+#include "se-boot-src/log.h"
+#include "se-boot-src/log_ring.h"
+#include "se-boot-src/log_store.h"
+
+#define BENCH_LINES (200000)
+#define BENCH_CHUNK (1023) // 与process_run单次read的大小一致
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void reset_log() {
+    char path[256];
+    for (int gen = log_gen_last(SE_LOG); gen >= 0; gen--) {
+        log_gen_path(SE_LOG, gen, path, sizeof(path));
+        unlink(path);
+        strcat(path, LOG_ARCHIVE_SUFFIX);
+        unlink(path);
+    }
+}
+
+// 生成模拟服务输出，每行约60字节
+static char *make_output(size_t *size) {
+    char *buffer = malloc(BENCH_LINES * 80);
+    size_t len   = 0;
+    for (int i = 0; i < BENCH_LINES; i++) {
+        len += sprintf(buffer + len, "GET /api/v1/items/%d HTTP/1.1 200 OK elapsed=%dus\n", i, i % 977);
+    }
+    *size = len;
+    return buffer;
+}
+
+static double bench_log_write(char *output, size_t size) {
+    reset_log();
+    double start = now();
+    char *line   = output;
+    char *end    = output + size;
+    while (line < end) {
+        char *next = memchr(line, '\n', end - line);
+        *next      = '\0';
+        log_write(LOG_TYPE_PROCESS, 1234, "/usr/bin/bench", "bench", line);
+        *next = '\n';
+        line  = next + 1;
+    }
+    return now() - start;
+}
+
+static double bench_log_writer(char *output, size_t size) {
+    reset_log();
+    char *chunk = malloc(BENCH_CHUNK);
+    log_writer_t writer;
+    double start = now();
+    log_writer_open(&writer, LOG_TYPE_PROCESS, 1234, "/usr/bin/bench", "bench");
+    for (size_t off = 0; off < size; off += BENCH_CHUNK) {
+        size_t len = size - off < BENCH_CHUNK ? size - off : BENCH_CHUNK;
+        memcpy(chunk, output + off, len);
+        log_writer_write(&writer, chunk, len);
+    }
+    log_writer_close(&writer);
+    double elapsed = now() - start;
+    free(chunk);
+    return elapsed;
+}
+
+// 生产者写入共享内存日志环的耗时，不含消费者写文件的时间
+static double bench_ring_push(char *output, size_t size) {
+    reset_log();
+    if (log_ring_create() < 0) {
+        return -1;
+    }
+
+    char head[] = "[1792235806511][0][1234][/usr/bin/bench][bench]:";
+    struct iovec iov[3] = {{head, sizeof(head) - 1}, {NULL, 0}, {"\n", 1}};
+    log_writer_t writer;
+    log_writer_open(&writer, LOG_TYPE_BOOT, 0, "/", "bench");
+
+    double elapsed = 0;
+    char *line     = output;
+    char *end      = output + size;
+    while (line < end) {
+        // 每批不超过环容量的一半，批间由消费者写出
+        double start = now();
+        for (int i = 0; i < 512 && line < end; i++) {
+            char *next      = memchr(line, '\n', end - line);
+            iov[1].iov_base = line;
+            iov[1].iov_len  = next - line;
+            log_ring_push(iov, 3);
+            line = next + 1;
+        }
+        elapsed += now() - start;
+        log_ring_drain(&writer);
+    }
+
+    log_writer_close(&writer);
+    log_ring_destroy();
+    return elapsed;
+}
+
+int main() {
+    mkdir(SE_DIR, 0777);
+
+    size_t size;
+    char *output = make_output(&size);
+
+    double t1 = bench_log_write(output, size);
+    printf("log_write (per line):   %10.0f lines/s, %6.0f ns/line\n", BENCH_LINES / t1, t1 * 1e9 / BENCH_LINES);
+
+    double t2 = bench_log_writer(output, size);
+    printf("log_writer (per read):  %10.0f lines/s\n", BENCH_LINES / t2);
+
+    double t3 = bench_ring_push(output, size);
+    printf("log_ring_push:          %10.0f ns/line\n", t3 * 1e9 / BENCH_LINES);
+
+    reset_log();
+    free(output);
+    return 0;
+}
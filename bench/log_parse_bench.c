@@ -0,0 +1,137 @@
+// 日志解析基准: 对比原fgets + sscanf逐行解析与mmap单遍解析的吞吐
+// 使用 make bench 编译运行，可通过参数指定合成日志的大小（MB，默认1024）
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "se-boot-src/path.h"
+#include "se-boot-src/log.h"
+#include "se-boot-src/log_record.h"
+
+#define BENCH_DEFAULT_SIZE_MB (1024)
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 生成约size字节的文本格式日志
+static long long make_log(long long size) {
+    FILE *file = fopen(SE_LOG, "w");
+    if (!file) {
+        perror(SE_LOG);
+        return -1;
+    }
+
+    char line[256];
+    long long total = 0;
+    long timestamp  = 1792235806511;
+    for (long i = 0; total < size; i++) {
+        timestamp += i % 3;
+        int len = sprintf(line, "[%ld][%d][%ld][/etc/se_boot/service%ld.sh][service%ld.sh]:GET /api/v1/items/%ld HTTP/1.1 200 OK elapsed=%ldus\n",
+                          timestamp, (int)(i % 2), 1000 + i % 17, i % 5, i % 5, i, i % 977);
+        fwrite(line, 1, len, file);
+        total += len;
+    }
+    fclose(file);
+    return total;
+}
+
+// 原实现：fgets读入2KiB栈缓冲区，再用sscanf复制出各字段
+static double bench_sscanf(long long *records) {
+    char line[2048];
+    long timestamp;
+    int type, pid;
+    char path[256], name[256], msg[1024];
+
+    FILE *file = fopen(SE_LOG, "r");
+    if (!file) {
+        return -1;
+    }
+
+    double start = now();
+    *records     = 0;
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "[%ld][%d][%d][%255[^][]][%255[^][]]:%1023[^\n]", &timestamp, &type, &pid, path, name, msg) == 6) {
+            (*records)++;
+        }
+    }
+    double elapsed = now() - start;
+    fclose(file);
+    return elapsed;
+}
+
+// 新实现：mmap整个文件，记录字段直接指向映射区
+static double bench_scan(long long *records) {
+    log_scan_t scan;
+    log_record_t record;
+
+    double start = now();
+    if (log_scan_open(&scan, SE_LOG, 0) < 0) {
+        return -1;
+    }
+
+    *records = 0;
+    while (log_scan_next(&scan, &record)) {
+        (*records)++;
+    }
+    log_scan_close(&scan);
+    return now() - start;
+}
+
+// 完整查询：遍历全部记录并按名称过滤（不匹配任何记录，不计输出）
+static double bench_query() {
+    char *argv[] = {"se-boot", "log", "-c", "-1", "-n", "none.sh", NULL};
+
+    double start = now();
+    optind       = 1;
+    log_read_main(6, argv);
+    return now() - start;
+}
+
+// 统计模式：按名称/pid/类型和每分钟聚合全部记录，不格式化
+static double bench_stats() {
+    char *argv[] = {"se-boot", "log", "--stats", "--bucket", "1m", "-o", "/dev/null", NULL};
+
+    double start = now();
+    optind       = 1;
+    log_read_main(7, argv);
+    return now() - start;
+}
+
+static void report(const char *name, long long size, long long records, double elapsed) {
+    printf("%-28s %8.0f MB/s, %10.0f records/s\n", name, size / elapsed / (1024 * 1024), records / elapsed);
+}
+
+int main(int argc, char *argv[]) {
+    long long size_mb = argc > 1 ? atoll(argv[1]) : BENCH_DEFAULT_SIZE_MB;
+    long long records;
+
+    mkdir(SE_DIR, 0777);
+    unlink(SE_LOG_INDEX);
+
+    long long size = make_log(size_mb * 1024 * 1024);
+    if (size < 0) {
+        return 1;
+    }
+    printf("synthetic log: %lld MB\n", size / (1024 * 1024));
+
+    double t1 = bench_sscanf(&records);
+    report("fgets + sscanf (before):", size, records, t1);
+
+    double t2 = bench_scan(&records);
+    report("mmap single pass (after):", size, records, t2);
+
+    double t3 = bench_query();
+    report("se-boot log -c -1 -n ...:", size, records, t3);
+
+    double t4 = bench_stats();
+    report("se-boot log --stats:", size, records, t4);
+
+    unlink(SE_LOG);
+    return 0;
+}
@@ -0,0 +1,119 @@
+// 输出延迟基准: 子进程用printf输出一行（不调用fflush）到该行写入日志的延迟，对比管道与伪终端捕获
+// 被启动的命令是本程序自身（--emit），每行带上输出时的时间戳；管道模式下stdio全缓冲，输出要等到缓冲区满或退出
+// 使用 make bench 编译，日志写入到 SE_DIR（基准编译时重定向到 /tmp/se_boot_bench）
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "se-boot-src/path.h"
+#include "se-boot-src/proc.h"
+#include "se-boot-src/service.h"
+#include "se-boot-src/log_record.h"
+
+#define BENCH_LINES (100)
+#define BENCH_INTERVAL_US (10000) // 两行之间的间隔
+#define BENCH_TIMEOUT (10000)     // 等待全部行写入日志的超时（毫秒）
+#define BENCH_MARK "pty_bench "
+
+static long now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static int compare_long(const void *a, const void *b) {
+    long x = *(const long *)a;
+    long y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_capture(const char **argv, int pty) {
+    const char *mode = pty ? "pty" : "pipe";
+    long samples[BENCH_LINES];
+
+    // 从当前日志末尾开始跟随
+    int fd = open(SE_LOG, O_WRONLY | O_CREAT | O_CLOEXEC, 0666);
+    if (fd >= 0) {
+        close(fd);
+    }
+    struct stat st;
+    log_scan_t scan;
+    if (stat(SE_LOG, &st) < 0 || log_scan_open(&scan, SE_LOG, 1) < 0) {
+        perror(SE_LOG);
+        return;
+    }
+    log_scan_seek(&scan, st.st_size);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        service_opt_t opt;
+        service_opt_init(&opt);
+        opt.pty = pty;
+        create_daemon(argv, &opt);
+        _exit(0);
+    }
+    if (pid < 0) {
+        log_scan_close(&scan);
+        return;
+    }
+    waitpid(pid, NULL, 0);
+
+    int count     = 0;
+    long deadline = now_ns() + BENCH_TIMEOUT * 1000000L;
+    while (count < BENCH_LINES && now_ns() < deadline) {
+        log_record_t record;
+        if (!log_scan_next(&scan, &record)) {
+            usleep(100);
+            continue;
+        }
+        long now = now_ns();
+        if (record.msg_len > strlen(BENCH_MARK) && memcmp(record.msg, BENCH_MARK, strlen(BENCH_MARK)) == 0) {
+            samples[count++] = now - atol(record.msg + strlen(BENCH_MARK));
+        }
+    }
+    log_scan_close(&scan);
+
+    if (count == 0) {
+        printf("%-5s failed\n", mode);
+        return;
+    }
+
+    qsort(samples, count, sizeof(long), compare_long);
+    printf("%-5s lines=%-4d p50=%9.3f ms  p99=%9.3f ms  max=%9.3f ms\n", mode, count, samples[count / 2] / 1e6,
+           samples[(count * 99) / 100] / 1e6, samples[count - 1] / 1e6);
+}
+
+int main(int argc, char **argv) {
+    // 被启动的子进程：按间隔输出带时间戳的行，不主动刷新
+    if (argc == 2 && strcmp(argv[1], "--emit") == 0) {
+        for (int i = 0; i < BENCH_LINES; i++) {
+            printf(BENCH_MARK "%ld\n", now_ns());
+            usleep(BENCH_INTERVAL_US);
+        }
+        return 0;
+    }
+
+    char self[PATH_MAX];
+    ssize_t len = readlink("/proc/self/exe", self, sizeof(self) - 1);
+    if (len < 0) {
+        perror("readlink");
+        return 1;
+    }
+    self[len] = '\0';
+
+    // 避免测量期间日志轮转
+    setenv("SE_LOG_MAX_SIZE", "1G", 1);
+    mkdir(SE_DIR, 0777);
+
+    const char *emit_argv[] = {"se-boot", self, "--emit", NULL};
+    bench_capture(emit_argv, 0);
+    bench_capture(emit_argv, 1);
+    return 0;
+}
@@ -0,0 +1,169 @@
+// 启动延迟基准: 测量从se-boot <command>调用到子进程exec的p50/p99，覆盖不同的nofile上限
+// 被启动的命令是本程序自身（--mark），进入main后立即通过FIFO报告时间戳
+// 使用 make bench 编译，日志写入到 SE_DIR（基准编译时重定向到 /tmp/se_boot_bench）
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "se-boot-src/path.h"
+#include "se-boot-src/proc.h"
+#include "se-boot-src/supervisor.h"
+#include "se-boot-src/service.h"
+
+#define BENCH_RUNS (100)
+#define BENCH_FIFO SE_DIR "/spawn_bench.fifo"
+#define BENCH_MARK_TIMEOUT (10000) // 等待子进程报告的超时（毫秒）
+
+static long now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static int compare_long(const void *a, const void *b) {
+    long x = *(const long *)a;
+    long y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+// 设置nofile上限，超过当前硬上限时需要root
+static int set_nofile(rlim_t limit) {
+    struct rlimit rl;
+    getrlimit(RLIMIT_NOFILE, &rl);
+    rl.rlim_cur = limit;
+    if (rl.rlim_max < limit) {
+        rl.rlim_max = limit;
+    }
+    return setrlimit(RLIMIT_NOFILE, &rl);
+}
+
+// 启动一次并返回调用到exec的纳秒数，失败返回-1
+static long spawn_once(int fifo_fd, const char **argv) {
+    fflush(stdout);
+    long start = now_ns();
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        service_opt_t opt;
+        service_opt_init(&opt);
+        create_daemon(argv, &opt);
+        _exit(0);
+    }
+    if (pid < 0) {
+        return -1;
+    }
+
+    long mark = -1;
+    struct pollfd pfd = {fifo_fd, POLLIN, 0};
+    if (poll(&pfd, 1, BENCH_MARK_TIMEOUT) <= 0 || read(fifo_fd, &mark, sizeof(mark)) != sizeof(mark)) {
+        mark = -1;
+    }
+    waitpid(pid, NULL, 0);
+    return (mark < 0) ? -1 : mark - start;
+}
+
+static void bench_spawn(int fifo_fd, const char **argv, const char *mode, rlim_t limit) {
+    long samples[BENCH_RUNS];
+
+    if (set_nofile(limit) < 0) {
+        printf("%-10s nofile=%-8lu skipped (setrlimit failed)\n", mode, (unsigned long)limit);
+        return;
+    }
+
+    // 监管进程在设置nofile之后启动，与实际部署一致
+    pid_t supervisor = -1;
+    if (strcmp(mode, "supervisor") == 0) {
+        int ctl_fd = supervisor_open();
+        if (ctl_fd < 0) {
+            printf("%-10s nofile=%-8lu skipped (no pidfd support)\n", mode, (unsigned long)limit);
+            return;
+        }
+        fflush(stdout);
+        supervisor = fork();
+        if (supervisor == 0) {
+            supervisor_run(ctl_fd);
+            _exit(0);
+        }
+        close(ctl_fd);
+    }
+
+    int count = 0;
+    for (int i = 0; i < BENCH_RUNS; i++) {
+        long ns = spawn_once(fifo_fd, argv);
+        if (ns >= 0) {
+            samples[count++] = ns;
+        }
+    }
+
+    if (supervisor > 0) {
+        kill(supervisor, SIGTERM);
+        waitpid(supervisor, NULL, 0);
+    }
+
+    if (count == 0) {
+        printf("%-10s nofile=%-8lu failed\n", mode, (unsigned long)limit);
+        return;
+    }
+
+    qsort(samples, count, sizeof(long), compare_long);
+    printf("%-10s nofile=%-8lu runs=%-4d p50=%8.3f ms  p99=%8.3f ms\n", mode, (unsigned long)limit, count,
+           samples[count / 2] / 1e6, samples[(count * 99) / 100] / 1e6);
+}
+
+int main(int argc, char **argv) {
+    // 被启动的子进程：报告exec完成的时间
+    if (argc == 2 && strcmp(argv[1], "--mark") == 0) {
+        long t = now_ns();
+        int fd = open(BENCH_FIFO, O_WRONLY);
+        if (fd >= 0) {
+            write(fd, &t, sizeof(t));
+            close(fd);
+        }
+        return 0;
+    }
+
+    char self[PATH_MAX];
+    ssize_t len = readlink("/proc/self/exe", self, sizeof(self) - 1);
+    if (len < 0) {
+        perror("readlink");
+        return 1;
+    }
+    self[len] = '\0';
+
+    mkdir(SE_DIR, 0777);
+    unlink(BENCH_FIFO);
+    if (mkfifo(BENCH_FIFO, 0666) < 0) {
+        perror(BENCH_FIFO);
+        return 1;
+    }
+
+    // 以读写方式打开，避免在没有写入者时阻塞或读到EOF
+    int fifo_fd = open(BENCH_FIFO, O_RDWR | O_CLOEXEC);
+    if (fifo_fd < 0) {
+        perror(BENCH_FIFO);
+        return 1;
+    }
+
+    const char *spawn_argv[] = {"se-boot", self, "--mark", NULL};
+    const rlim_t limits[]    = {1024, 16384, 65536, 1048576};
+    const char *modes[]      = {"daemon", "supervisor"};
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        for (size_t i = 0; i < sizeof(limits) / sizeof(limits[0]); i++) {
+            bench_spawn(fifo_fd, spawn_argv, modes[m], limits[i]);
+        }
+    }
+
+    close(fifo_fd);
+    unlink(BENCH_FIFO);
+    return 0;
+}
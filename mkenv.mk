@@ -1,49 +1,50 @@
-
-
-TOP = .
-
-CROSS =
-CC = $(CROSS)gcc
-CXX = $(CROSS)g++
-LD = $(CROSS)ld
-AS = $(CC)
-AR = $(CROSS)ar
-OBJCOPY = $(CROSS)objcopy
-OBJDUMP = $(CROSS)objdump
-
-MKDIR = mkdir
-CP = cp
-
-BUILD = build
-TARGET = $(BUILD)/se-boot
-
-# CFLAGS += -std=gnu99
-CFLAGS += -Wno-unused-result
-
-# LDFLAGS +=
-LDFLAGS +=
-
-INC += -I. -I"./$(BUILD)" -I"$(TOP)" -I"$(TOP)/se-boot"
-
-LIB +=
-
-PREBUILD =
-
-ifeq ($(DEBUG), 1)
-CFLAGS += -O0 -g
-CXXFLAGS += -O0 -g
-ASFLAGS += -O0 -g
-
-else
-CFLAGS += -Os -g
-CXXFLAGS += -Os -g
-ASFLAGS += -Os -g
-endif
-
-ifeq ($(PG), 1)
-CFLAGS += -pg
-CXXFLAGS += -pg
-ASFLAGS += -pg
-LDFLAGS += -pg
-endif
-
+
+
+TOP = .
+
+CROSS =
+CC = $(CROSS)gcc
+CXX = $(CROSS)g++
+LD = $(CROSS)ld
+AS = $(CC)
+AR = $(CROSS)ar
+OBJCOPY = $(CROSS)objcopy
+OBJDUMP = $(CROSS)objdump
+
+MKDIR = mkdir
+CP = cp
+
+BUILD = build
+TARGET = $(BUILD)/se-boot
+
+# CFLAGS += -std=gnu99
+CFLAGS += -Wno-unused-result
+CFLAGS += -pthread
+
+# LDFLAGS +=
+LDFLAGS +=
+
+INC += -I. -I"./$(BUILD)" -I"$(TOP)" -I"$(TOP)/se-boot"
+
+LIB += -lpthread
+
+PREBUILD =
+
+ifeq ($(DEBUG), 1)
+CFLAGS += -O0 -g
+CXXFLAGS += -O0 -g
+ASFLAGS += -O0 -g
+
+else
+CFLAGS += -Os -g
+CXXFLAGS += -Os -g
+ASFLAGS += -Os -g
+endif
+
+ifeq ($(PG), 1)
+CFLAGS += -pg
+CXXFLAGS += -pg
+ASFLAGS += -pg
+LDFLAGS += -pg
+endif
+
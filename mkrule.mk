@@ -1,15 +1,29 @@
-$(TARGET): $(OBJ_DIR_1)
-	$(CC) $(LDFLAGS) -o $@ $(OBJ_DIR_1) $(LIB)
-
-install:
-	sudo cp $(TARGET) /bin/se-boot
-
-uninstall:
-	sudo rm /bin/se-boot
-
-systemctl-install: install
-	sudo chmod +x ser.sh
-	sudo ./ser.sh
-
-systemctl-uninstall:
-	sudo ./ser.sh clean
+$(TARGET): $(OBJ_DIR_1)
+	$(CC) $(LDFLAGS) -o $@ $(OBJ_DIR_1) $(LIB)
+
+install:
+	sudo cp $(TARGET) /bin/se-boot
+
+uninstall:
+	sudo rm /bin/se-boot
+
+systemctl-install: install
+	sudo chmod +x ser.sh
+	sudo ./ser.sh
+
+systemctl-uninstall:
+	sudo ./ser.sh clean
+
+BENCH_DIR = $(BUILD)/bench
+BENCH_SRC = $(filter-out %/main.c, $(wildcard $(TOP)/se-boot-src/*.c))
+BENCH_CFLAGS = $(CFLAGS) -DSE_DIR='"/tmp/se_boot_bench"'
+
+bench: $(BENCH_DIR)/log_bench $(BENCH_DIR)/log_parse_bench $(BENCH_DIR)/spawn_bench $(BENCH_DIR)/pty_bench
+	$(BENCH_DIR)/log_bench
+	$(BENCH_DIR)/log_parse_bench
+	$(BENCH_DIR)/spawn_bench
+	$(BENCH_DIR)/pty_bench
+
+$(BENCH_DIR)/%: $(TOP)/bench/%.c $(BENCH_SRC)
+	$(MKDIR) -p $(BENCH_DIR)
+	$(CC) $(BENCH_CFLAGS) $(INC) -o $@ $^ $(LDFLAGS) $(LIB)
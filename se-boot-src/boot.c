@@ -15,6 +15,9 @@
 #include "se-boot-src/path.h"
 #include "se-boot-src/log.h"
 #include "se-boot-src/proc.h"
+#include "se-boot-src/log_server.h"
+#include "se-boot-src/log_ring.h"
+#include "se-boot-src/supervisor.h"
 
 /* 脚本信息结构体 */
 typedef struct {
@@ -30,66 +33,8 @@ static int script_compare(const void *a, const void *b) {
     return sa->number - sb->number;
 }
 
-void boot_main() {
-
-    /* 第1步：确保存在 */
-    int lock_file = open(SE_LOCK, O_CREAT|O_RDWR, 0666);
-
-    if (lock_file == -1){
-        log_write(LOG_TYPE_BOOT, getpid(), "/", "se-boot", strerror(errno));
-        return;
-    }
-
-    if (flock(lock_file, LOCK_EX | LOCK_NB) == -1){
-        if (errno == EWOULDBLOCK){
-            return;
-        }
-        else{
-            log_write(LOG_TYPE_BOOT, getpid(), "/", "se-boot", strerror(errno));
-            return;
-        }
-    }
-
-    pid_t process_t1 = fork();
-    
-    if (process_t1 < 0){
-        return;
-    }
-    if (process_t1 > 0){
-        waitpid(process_t1, NULL, 0);
-        return;
-    }
-
-    process_t1 = getpid();
-
-    pid_t process_t2 = fork();
-    if (process_t2 < 0){
-        return;
-    }
-    if (process_t2 > 0){
-        pause();
-        return;
-    }
-
-    if (daemonize() < 0){
-        kill(process_t1, SIGUSR1);
-        return;
-    }
-
-
-    /* 第3步：写入当前PID到文件 */
-    FILE *pid_file = fopen(SE_PID_FILE, "w");
-    if (!pid_file) {
-        log_write(LOG_TYPE_BOOT, getpid(), "/", "se-boot", strerror(errno));
-        kill(process_t1, SIGUSR1);
-        return;
-    }
-
-    fprintf(pid_file, "%d", getpid());
-    fclose(pid_file);
-    kill(process_t1, SIGUSR1);
-
-    /* 第4步：执行/etc/se_init下的脚本 */
+/* 第4步：执行/etc/se_init下的脚本 */
+static void boot_scripts() {
 
     struct stat st = {0};
     if (stat(SCRIPT_DIR, &st) == -1) {
@@ -170,7 +115,15 @@ void boot_main() {
 
             if (pid == 0){
                 const char *argv[3] = {scripts[i].path, scripts[i].path, NULL};
-                process_run(argv);
+
+                // 脚本中的"#se-boot: key=value"元数据覆盖环境变量中的默认选项
+                service_opt_t opt;
+                service_opt_init(&opt);
+                if (service_opt_script(&opt, scripts[i].path) < 0) {
+                    snprintf(msg, sizeof(msg), "%s :invalid #se-boot options!", scripts[i].path);
+                    log_write(LOG_TYPE_BOOT, getpid(), "/", "se-boot", msg);
+                }
+                process_run(argv, &opt);
                 exit(0);
                 return;
             }
@@ -206,6 +159,136 @@ void boot_main() {
             break;
         }
     }
+}
+
+void boot_main() {
+
+    /* 第1步：确保存在 */
+    int lock_file = open(SE_LOCK, O_CREAT|O_RDWR, 0666);
+
+    if (lock_file == -1){
+        log_write(LOG_TYPE_BOOT, getpid(), "/", "se-boot", strerror(errno));
+        return;
+    }
+
+    if (flock(lock_file, LOCK_EX | LOCK_NB) == -1){
+        if (errno == EWOULDBLOCK){
+            return;
+        }
+        else{
+            log_write(LOG_TYPE_BOOT, getpid(), "/", "se-boot", strerror(errno));
+            return;
+        }
+    }
+
+    pid_t process_t1 = fork();
+    
+    if (process_t1 < 0){
+        return;
+    }
+    if (process_t1 > 0){
+        waitpid(process_t1, NULL, 0);
+        return;
+    }
+
+    process_t1 = getpid();
+
+    pid_t process_t2 = fork();
+    if (process_t2 < 0){
+        return;
+    }
+    if (process_t2 > 0){
+        pause();
+        return;
+    }
+
+    if (daemonize() < 0){
+        kill(process_t1, SIGUSR1);
+        return;
+    }
+
+
+    /* 第3步：写入当前PID到文件 */
+    FILE *pid_file = fopen(SE_PID_FILE, "w");
+    if (!pid_file) {
+        log_write(LOG_TYPE_BOOT, getpid(), "/", "se-boot", strerror(errno));
+        kill(process_t1, SIGUSR1);
+        return;
+    }
+
+    fprintf(pid_file, "%d", getpid());
+    fclose(pid_file);
+    kill(process_t1, SIGUSR1);
+
+    /* 启用日志聚合或日志环时，本进程作为唯一写入者，脚本交由子进程执行 */
+    int log_server_fd = -1;
+    if (log_server_enabled()) {
+        log_server_fd = log_server_open();
+        if (log_server_fd < 0) {
+            log_write(LOG_TYPE_BOOT, getpid(), "/", "se-boot", strerror(errno));
+        }
+    }
+
+    int log_ring = 0;
+    if (log_ring_enabled()) {
+        log_ring = log_ring_create() == 0;
+        if (!log_ring) {
+            log_write(LOG_TYPE_BOOT, getpid(), "/", "se-boot", strerror(errno));
+        }
+    }
+
+    /* 启用监管模式时，由独立的子进程接收se-boot <command>的启动请求并持有所有后台程序 */
+    if (supervisor_enabled()) {
+        int ctl_fd = supervisor_open();
+        if (ctl_fd < 0) {
+            log_write(LOG_TYPE_BOOT, getpid(), "/", "se-boot", strerror(errno));
+        } else {
+            pid_t supervisor = fork();
+            if (supervisor < 0) {
+                log_write(LOG_TYPE_BOOT, getpid(), "/", "se-boot", strerror(errno));
+                unlink(SE_CTL_SOCK);
+            }
+
+            if (supervisor == 0) {
+                if (log_server_fd >= 0) {
+                    close(log_server_fd);
+                }
+                supervisor_run(ctl_fd);
+                exit(0);
+            }
+
+            close(ctl_fd);
+        }
+    }
+
+    if (log_server_fd >= 0 || log_ring) {
+        pid_t runner = fork();
+        if (runner < 0) {
+            log_write(LOG_TYPE_BOOT, getpid(), "/", "se-boot", strerror(errno));
+        }
+
+        if (runner == 0) {
+            if (log_server_fd >= 0) {
+                close(log_server_fd);
+            }
+            boot_scripts();
+            exit(0);
+        }
+
+        if (runner > 0) {
+            log_server_run(log_server_fd, log_ring);
+        }
+
+        if (log_server_fd >= 0) {
+            close(log_server_fd);
+            unlink(SE_LOG_SOCK);
+        }
+        if (log_ring) {
+            log_ring_destroy();
+        }
+    }
+
+    boot_scripts();
 
     while (1){
         pause();
@@ -1,14 +1,14 @@
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-#ifndef SE_BOOT_BOOT_H
-#define SE_BOOT_BOOT_H
-
-void boot_main();
-
-#endif
-
-#ifdef __cplusplus
-}
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_BOOT_H
+#define SE_BOOT_BOOT_H
+
+void boot_main();
+
+#endif
+
+#ifdef __cplusplus
+}
 #endif
\ No newline at end of file
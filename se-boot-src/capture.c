@@ -0,0 +1,300 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <termios.h>
+#include <sys/epoll.h>
+#include "se-boot-src/capture.h"
+#include "se-boot-src/conf.h"
+
+// 所有捕获共用的读缓冲区，读到的数据在返回前已全部写出或暂存到carry
+static char capture_buffer[CAPTURE_READ_SIZE];
+
+// 单条记录消息的最大字节数，由环境变量SE_LOG_MAX_RECORD配置（支持K后缀），超过的行被切分为多条记录
+size_t capture_max_record() {
+    static long max_record = -1;
+    if (max_record < 0) {
+        max_record = conf_size("SE_LOG_MAX_RECORD", CAPTURE_RECORD_DEFAULT);
+        if (max_record < 64) {
+            max_record = 64;
+        } else if (max_record > CAPTURE_RECORD_LIMIT) {
+            max_record = CAPTURE_RECORD_LIMIT;
+        }
+    }
+    return max_record;
+}
+
+static int stream_init(capture_stream_t *stream, int fd, int type, int pty, size_t max_record) {
+    stream->fd        = fd;
+    stream->type      = type;
+    stream->pty       = pty;
+    stream->carry_len = 0;
+    stream->carry     = NULL;
+    if (fd < 0) {
+        return 0;
+    }
+
+    stream->carry = malloc(max_record);
+    if (!stream->carry) {
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return 1;
+}
+
+// 创建伪终端，子进程的stdout（及stdin）使用从端时libc按行缓冲，输出不会在缓冲区中积压。
+// 从端设为raw模式：不回显、不把'\n'转换为"\r\n"，子进程看到的是终端，写出的字节原样到达主端。
+// 从端以O_NOCTTY打开且子进程不将其设为控制终端，主端关闭时不会收到SIGHUP
+int capture_pty(int *master_fd, int *slave_fd) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (master < 0) {
+        return -1;
+    }
+
+    char name[64];
+    if (grantpt(master) < 0 || unlockpt(master) < 0 || ptsname_r(master, name, sizeof(name)) != 0) {
+        close(master);
+        return -1;
+    }
+
+    int slave = open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (slave < 0) {
+        close(master);
+        return -1;
+    }
+
+    struct termios tio;
+    if (tcgetattr(slave, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(slave, TCSANOW, &tio);
+    }
+
+    *master_fd = master;
+    *slave_fd  = slave;
+    return 0;
+}
+
+// out_fd/err_fd为子进程stdout/stderr管道的读端，err_fd为-1时只捕获一路；捕获对象接管两个fd。
+// pty非0时out_fd为伪终端的主端
+int capture_open(capture_t *capture, int pid, const char *path, const char *name, int out_fd, int err_fd, int pty) {
+    capture->max_record = capture_max_record();
+    capture->open_count = 0;
+    capture->epfd       = -1;
+
+    int fds[CAPTURE_STREAMS]   = {out_fd, err_fd};
+    int types[CAPTURE_STREAMS] = {LOG_TYPE_PROCESS, LOG_TYPE_STDERR};
+    for (int i = 0; i < CAPTURE_STREAMS; i++) {
+        int ret = stream_init(&capture->streams[i], fds[i], types[i], pty && i == 0, capture->max_record);
+        if (ret < 0) {
+            for (int j = 0; j <= i; j++) {
+                free(capture->streams[j].carry);
+            }
+            return -1;
+        }
+        capture->open_count += ret;
+    }
+
+    // 打开失败时fd为-1，log_writer_write会在下次写入时重试打开
+    log_writer_open(&capture->writer, LOG_TYPE_PROCESS, pid, path, name);
+
+    // 超出限速的行在写入前丢弃，不占用日志锁和磁盘；有丢弃时定时汇总丢弃的行数
+    log_limit_init(&capture->limit);
+    return 0;
+}
+
+// 将一段数据（若干完整行，或被切分的一行）经限速后写入日志，记录类型为该路输出的类型
+// 子进程重新打开输出处理（stty onlcr等）或自行输出"\r\n"时，去掉行尾的'\r'。
+// data为若干完整的行或一行的一部分，行尾的'\r'在'\n'之前或data末尾
+static size_t strip_cr(char *data, size_t size) {
+    char *cr = memchr(data, '\r', size);
+    if (!cr) {
+        return size;
+    }
+
+    char *out = cr;
+    for (char *p = cr; p < data + size; p++) {
+        if (*p == '\r' && (p + 1 == data + size || p[1] == '\n')) {
+            continue;
+        }
+        *out++ = *p;
+    }
+    return out - data;
+}
+
+static void capture_emit(capture_t *capture, capture_stream_t *stream, char *data, size_t size) {
+    if (stream->pty) {
+        size = strip_cr(data, size);
+    }
+    size = log_limit_filter(&capture->limit, data, size);
+    if (size > 0) {
+        capture->writer.type = stream->type;
+        log_writer_write(&capture->writer, data, size);
+    }
+}
+
+// 按行切分一次read得到的数据：相邻的完整行一次交给写入器，超过上限的行按上限切分，
+// 末尾未完成的行暂存到carry，与下次读取的数据拼接后再写出
+static void capture_assemble(capture_t *capture, capture_stream_t *stream, char *data, size_t size) {
+    size_t max = capture->max_record;
+    char *p    = data;
+    char *end  = data + size;
+
+    if (stream->carry_len > 0) {
+        char *nl   = memchr(p, '\n', end - p);
+        char *stop = nl ? nl : end;
+        size_t len = stop - p;
+        if (len > max - stream->carry_len) {
+            len = max - stream->carry_len;
+        }
+        memcpy(stream->carry + stream->carry_len, p, len);
+        stream->carry_len += len;
+        p += len;
+
+        if (nl && p == nl) {
+            capture_emit(capture, stream, stream->carry, stream->carry_len);
+            stream->carry_len = 0;
+            p++;
+        } else if (stream->carry_len == max) {
+            // 行的其余部分作为新的一行继续处理
+            capture_emit(capture, stream, stream->carry, stream->carry_len);
+            stream->carry_len = 0;
+        } else {
+            return;
+        }
+    }
+
+    char *region = p;
+    while (p < end) {
+        char *nl = memchr(p, '\n', end - p);
+        if (!nl) {
+            break;
+        }
+        if ((size_t)(nl - p) > max) {
+            if (p > region) {
+                capture_emit(capture, stream, region, p - region);
+            }
+            while ((size_t)(nl - p) > max) {
+                capture_emit(capture, stream, p, max);
+                p += max;
+            }
+            region = p;
+        }
+        p = nl + 1;
+    }
+    if (p > region) {
+        capture_emit(capture, stream, region, p - region);
+    }
+
+    while ((size_t)(end - p) >= max) {
+        capture_emit(capture, stream, p, max);
+        p += max;
+    }
+    memcpy(stream->carry, p, end - p);
+    stream->carry_len = end - p;
+}
+
+static void capture_stream_close(capture_t *capture, capture_stream_t *stream) {
+    if (stream->fd < 0) {
+        return;
+    }
+    if (stream->carry_len > 0) {
+        capture_emit(capture, stream, stream->carry, stream->carry_len);
+        stream->carry_len = 0;
+    }
+    if (capture->epfd >= 0) {
+        epoll_ctl(capture->epfd, EPOLL_CTL_DEL, stream->fd, NULL);
+    }
+    close(stream->fd);
+    stream->fd = -1;
+    capture->open_count--;
+}
+
+// 读取一路输出一次，返回0表示该路已关闭（EOF或出错），未完成的行在关闭时写出
+int capture_read(capture_t *capture, int index) {
+    capture_stream_t *stream = &capture->streams[index];
+    if (stream->fd < 0) {
+        return 0;
+    }
+
+    ssize_t bytes_read = read(stream->fd, capture_buffer, sizeof(capture_buffer));
+    if (bytes_read < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return 1;
+    }
+    if (bytes_read <= 0) {
+        capture_stream_close(capture, stream);
+        return 0;
+    }
+
+    capture_assemble(capture, stream, capture_buffer, bytes_read);
+    capture_report(capture, 0);
+    return 1;
+}
+
+// 距下次需要汇总丢弃行数的毫秒数，-1表示无需定时唤醒
+int capture_timeout(const capture_t *capture) {
+    return log_limit_timeout(&capture->limit);
+}
+
+void capture_report(capture_t *capture, int force) {
+    char msg[256];
+    if (log_limit_report(&capture->limit, force, msg, sizeof(msg))) {
+        log_write(LOG_TYPE_PROCESS, capture->writer.pid, capture->writer.path, capture->writer.name, msg);
+    }
+}
+
+// 通过epoll等待两路输出直到都关闭
+int capture_run(capture_t *capture) {
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        return -1;
+    }
+
+    for (int i = 0; i < CAPTURE_STREAMS; i++) {
+        if (capture->streams[i].fd < 0) {
+            continue;
+        }
+        struct epoll_event event = {.events = EPOLLIN, .data.u32 = i};
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, capture->streams[i].fd, &event) < 0) {
+            close(epfd);
+            return -1;
+        }
+    }
+
+    capture->epfd = epfd;
+
+    struct epoll_event events[CAPTURE_STREAMS];
+    while (capture->open_count > 0) {
+        int n = epoll_wait(epfd, events, CAPTURE_STREAMS, capture_timeout(capture));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (n == 0) {
+            capture_report(capture, 0);
+            continue;
+        }
+        for (int i = 0; i < n; i++) {
+            capture_read(capture, events[i].data.u32);
+        }
+    }
+
+    capture->epfd = -1;
+    close(epfd);
+    return 0;
+}
+
+// 写出各路未完成的行与最终的丢弃汇总，关闭管道与日志写入器
+void capture_close(capture_t *capture) {
+    for (int i = 0; i < CAPTURE_STREAMS; i++) {
+        capture_stream_close(capture, &capture->streams[i]);
+        free(capture->streams[i].carry);
+        capture->streams[i].carry = NULL;
+    }
+    capture_report(capture, 1);
+    log_writer_close(&capture->writer);
+}
@@ -0,0 +1,50 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_CAPTURE_H
+#define SE_BOOT_CAPTURE_H
+
+#include "se-boot-src/log.h"
+#include "se-boot-src/log_limit.h"
+#include "se-boot-src/log_record.h"
+
+#define CAPTURE_STREAMS 2                 // stdout与stderr
+#define CAPTURE_READ_SIZE (64 * 1024)     // 单次read的大小
+#define CAPTURE_RECORD_DEFAULT (1024)     // 单条记录消息的默认上限
+// 消息上限需保证path/name取最大长度时编码后仍不超过LOG_RECORD_MAX_SIZE
+#define CAPTURE_RECORD_LIMIT (LOG_RECORD_MAX_SIZE - LOG_RECORD_BIN_HEAD_SIZE - LOG_RECORD_BIN_TAIL_SIZE - 2 * LOG_RECORD_MAX_FIELD)
+
+// 一路输出：按行切分，read边界处未完成的行暂存在carry中与下次读取的数据拼接
+typedef struct capture_stream_t {
+    int fd; // 已关闭时为-1
+    int type; // 写入记录的类型，用于区分stdout/stderr
+    int pty;  // fd为伪终端的主端：去掉行尾的'\r'，从端全部关闭时read返回EIO视为EOF
+    char *carry;
+    size_t carry_len;
+} capture_stream_t;
+
+// 一个子进程的输出捕获：stdout/stderr各一个管道，共用一个日志写入器和限速器
+typedef struct capture_t {
+    log_writer_t writer;
+    log_limit_t limit;
+    capture_stream_t streams[CAPTURE_STREAMS];
+    int open_count; // 尚未关闭的管道数
+    int epfd; // 管道所在的epoll，关闭管道前先移除：fork出的子进程在exec前仍持有管道时，仅close不会移除
+    size_t max_record;
+} capture_t;
+
+size_t capture_max_record();
+int capture_pty(int *master_fd, int *slave_fd);
+int capture_open(capture_t *capture, int pid, const char *path, const char *name, int out_fd, int err_fd, int pty);
+int capture_read(capture_t *capture, int index);
+int capture_timeout(const capture_t *capture);
+void capture_report(capture_t *capture, int force);
+int capture_run(capture_t *capture);
+void capture_close(capture_t *capture);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,348 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "se-boot-src/cgroup.h"
+
+#define CGROUP_CPU_PERIOD (100000) // cpu_max只给出配额或百分比时使用的周期（微秒）
+
+typedef int (*cgroup_parse_t)(const char *value, char *out, size_t size);
+
+// 解析"max"或非负整数（可带K/M/G/T后缀，按1024进位），min为允许的最小值
+static int parse_number(const char *value, char *out, size_t size, long min, long max, int suffix) {
+    if (strcmp(value, "max") == 0 && max < 0) {
+        snprintf(out, size, "max");
+        return 0;
+    }
+
+    char *end;
+    long n = strtol(value, &end, 10);
+    if (end == value || n < min) {
+        return -1;
+    }
+    if (suffix && *end) {
+        const char *units = "KMGT";
+        const char *unit  = strchr(units, *end);
+        if (!unit || end[1] != '\0') {
+            return -1;
+        }
+        for (const char *u = units; u <= unit; u++) {
+            n *= 1024;
+        }
+    } else if (*end) {
+        return -1;
+    }
+    if (max >= 0 && n > max) {
+        return -1;
+    }
+
+    snprintf(out, size, "%ld", n);
+    return 0;
+}
+
+static int parse_bytes(const char *value, char *out, size_t size) {
+    return parse_number(value, out, size, 0, -1, 1);
+}
+
+static int parse_count(const char *value, char *out, size_t size) {
+    return parse_number(value, out, size, 0, -1, 0);
+}
+
+static int parse_weight(const char *value, char *out, size_t size) {
+    return parse_number(value, out, size, 1, 10000, 0);
+}
+
+// cpu_max: max、<配额>%（相对一个CPU）、<配额>或<配额>/<周期>（微秒）。保存为"配额/周期"，写入时换成空格
+static int parse_cpu_max(const char *value, char *out, size_t size) {
+    if (strcmp(value, "max") == 0) {
+        snprintf(out, size, "max");
+        return 0;
+    }
+
+    char *end;
+    long quota  = strtol(value, &end, 10);
+    long period = CGROUP_CPU_PERIOD;
+    if (end == value || quota <= 0) {
+        return -1;
+    }
+    if (strcmp(end, "%") == 0) {
+        quota = quota * CGROUP_CPU_PERIOD / 100;
+    } else if (*end == '/') {
+        char *period_end;
+        period = strtol(end + 1, &period_end, 10);
+        if (period_end == end + 1 || *period_end || period <= 0) {
+            return -1;
+        }
+    } else if (*end) {
+        return -1;
+    }
+
+    snprintf(out, size, "%ld/%ld", quota, period);
+    return 0;
+}
+
+// 选项名、控制文件、写入时的前缀、所需的控制器
+static const struct {
+    const char *key;
+    const char *file;
+    const char *prefix;
+    const char *controller;
+    cgroup_parse_t parse;
+} cgroup_controls[CGROUP_CONTROLS] = {
+    {"cpu_max", "cpu.max", "", "cpu", parse_cpu_max},
+    {"cpu_weight", "cpu.weight", "", "cpu", parse_weight},
+    {"memory_max", "memory.max", "", "memory", parse_bytes},
+    {"memory_high", "memory.high", "", "memory", parse_bytes},
+    {"io_weight", "io.weight", "default ", "io", parse_weight},
+    {"pids_max", "pids.max", "", "pids", parse_count},
+};
+
+// 写入退出记录的cpu.stat项
+static const char *cgroup_cpu_stats[] = {"usage_usec", "user_usec", "system_usec", "nr_throttled", "throttled_usec"};
+
+// 设置一项限制，选项名未知或值无效时返回-1且不修改
+int cgroup_limits_set(cgroup_limits_t *limits, const char *key, const char *value) {
+    if (strcmp(key, "cgroup") == 0) {
+        char *end;
+        long n = strtol(value, &end, 10);
+        if (end == value || *end) {
+            return -1;
+        }
+        limits->enabled = n > 0;
+        return 0;
+    }
+
+    for (int i = 0; i < CGROUP_CONTROLS; i++) {
+        if (strcmp(key, cgroup_controls[i].key) == 0) {
+            char parsed[CGROUP_VALUE_SIZE];
+            if (cgroup_controls[i].parse(value, parsed, sizeof(parsed)) < 0) {
+                return -1;
+            }
+            strcpy(limits->values[i], parsed);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// 格式化为service_opt_parse可解析的形式，以空格开头
+size_t cgroup_limits_dump(const cgroup_limits_t *limits, char *buffer, size_t size) {
+    size_t len = snprintf(buffer, size, " cgroup=%d", limits->enabled);
+    for (int i = 0; i < CGROUP_CONTROLS && len < size; i++) {
+        if (limits->values[i][0]) {
+            len += snprintf(buffer + len, size - len, " %s=%s", cgroup_controls[i].key, limits->values[i]);
+        }
+    }
+    return (len < size) ? len : size - 1;
+}
+
+int cgroup_limits_used(const cgroup_limits_t *limits) {
+    if (limits->enabled) {
+        return 1;
+    }
+    for (int i = 0; i < CGROUP_CONTROLS; i++) {
+        if (limits->values[i][0]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static const char *cgroup_root() {
+    static const char *root = NULL;
+    if (!root) {
+        const char *value = getenv("SE_CGROUP_ROOT");
+        root              = (value && *value) ? value : CGROUP_DEFAULT_ROOT;
+    }
+    return root;
+}
+
+static int write_file(const char *dir, const char *file, const char *prefix, const char *value) {
+    char path[PATH_MAX];
+    char text[64];
+    if (snprintf(path, sizeof(path), "%s/%s", dir, file) >= (int)sizeof(path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    int len = snprintf(text, sizeof(text), "%s%s", prefix, value);
+
+    // 控制文件由cgroupfs提供，不带O_CREAT：根不是cgroup2时写入失败，而不是创建普通文件使叶子无法删除
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    int ret = (write(fd, text, len) == len) ? 0 : -1;
+    int err = errno;
+    close(fd);
+    errno = err;
+    return ret;
+}
+
+// 在根及其父cgroup中启用所需的控制器：先一次写入全部，内核缺少其中某个控制器时整次写入失败，再逐个写入。
+// 失败时由之后写入控制文件的错误体现
+static void cgroup_enable(const char *root, const cgroup_limits_t *limits) {
+    char parent[PATH_MAX];
+    snprintf(parent, sizeof(parent), "%s", root);
+    char *slash = strrchr(parent, '/');
+    if (slash && slash != parent) {
+        *slash = '\0';
+    }
+
+    char all[64]   = "";
+    size_t len     = 0;
+    const char *dirs[] = {parent, root};
+    for (int i = 0; i < CGROUP_CONTROLS; i++) {
+        const char *controller = cgroup_controls[i].controller;
+        if (limits->values[i][0] && !strstr(all, controller)) {
+            len += snprintf(all + len, sizeof(all) - len, "%s+%s", len ? " " : "", controller);
+        }
+    }
+    if (len == 0) {
+        return;
+    }
+
+    for (int d = 0; d < 2; d++) {
+        if (write_file(dirs[d], "cgroup.subtree_control", "", all) == 0) {
+            continue;
+        }
+        for (int i = 0; i < CGROUP_CONTROLS; i++) {
+            if (limits->values[i][0]) {
+                write_file(dirs[d], "cgroup.subtree_control", "+", cgroup_controls[i].controller);
+            }
+        }
+    }
+}
+
+// 为一次运行创建叶子cgroup（<根>/<名称>.<pid>.<序号>）并写入限制，未设置cgroup选项时procs_fd为-1。
+// 无法创建叶子时返回-1；个别限制写入失败时仍返回0，原因写入msg（否则msg为空串）
+int cgroup_create(cgroup_t *cgroup, const cgroup_limits_t *limits, const char *name, char *msg, size_t msg_size) {
+    static unsigned int sequence = 0;
+
+    cgroup->procs_fd = -1;
+    cgroup->path[0]  = '\0';
+    msg[0]           = '\0';
+    if (!cgroup_limits_used(limits)) {
+        return 0;
+    }
+
+    const char *root = cgroup_root();
+    if (mkdir(root, 0755) < 0 && errno != EEXIST) {
+        snprintf(msg, msg_size, "cgroup %s: %s", root, strerror(errno));
+        return -1;
+    }
+    cgroup_enable(root, limits);
+
+    if (snprintf(cgroup->path, sizeof(cgroup->path), "%s/%s.%d.%u", root, name, getpid(), sequence++) >=
+        (int)sizeof(cgroup->path)) {
+        snprintf(msg, msg_size, "cgroup %s: %s", root, strerror(ENAMETOOLONG));
+        cgroup->path[0] = '\0';
+        return -1;
+    }
+    if (mkdir(cgroup->path, 0755) < 0 && errno != EEXIST) {
+        snprintf(msg, msg_size, "cgroup %s: %s", cgroup->path, strerror(errno));
+        return -1;
+    }
+
+    for (int i = 0; i < CGROUP_CONTROLS; i++) {
+        if (limits->values[i][0] == '\0') {
+            continue;
+        }
+        char value[CGROUP_VALUE_SIZE];
+        strcpy(value, limits->values[i]);
+        char *slash = strchr(value, '/');
+        if (slash) {
+            *slash = ' ';
+        }
+        if (write_file(cgroup->path, cgroup_controls[i].file, cgroup_controls[i].prefix, value) < 0 && msg[0] == '\0') {
+            snprintf(msg, msg_size, "cgroup %s=%s: %s", cgroup_controls[i].file, value, strerror(errno));
+        }
+    }
+
+    char path[PATH_MAX];
+    if (snprintf(path, sizeof(path), "%s/cgroup.procs", cgroup->path) >= (int)sizeof(path)) {
+        snprintf(msg, msg_size, "cgroup %s: %s", cgroup->path, strerror(ENAMETOOLONG));
+        rmdir(cgroup->path);
+        return -1;
+    }
+    cgroup->procs_fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (cgroup->procs_fd < 0) {
+        snprintf(msg, msg_size, "cgroup %s: %s", path, strerror(errno));
+        rmdir(cgroup->path);
+        return -1;
+    }
+    return 0;
+}
+
+// 在子进程exec前调用，将自身加入叶子cgroup；只使用系统调用，可在vfork出的子进程中调用
+int cgroup_enter(const cgroup_t *cgroup) {
+    if (cgroup->procs_fd < 0) {
+        return 0;
+    }
+    return (write(cgroup->procs_fd, "0", 1) == 1) ? 0 : -1;
+}
+
+static ssize_t read_file(const char *dir, const char *file, char *buffer, size_t size) {
+    char path[PATH_MAX];
+    if (snprintf(path, sizeof(path), "%s/%s", dir, file) >= (int)sizeof(path)) {
+        return -1;
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t len = read(fd, buffer, size - 1);
+    close(fd);
+    if (len < 0) {
+        return -1;
+    }
+    buffer[len] = '\0';
+    return len;
+}
+
+// 读取memory.peak与cpu.stat中的主要项，格式为" memory.peak=N cpu.usage_usec=N ..."；不存在的文件跳过
+size_t cgroup_stats(const cgroup_t *cgroup, char *buffer, size_t size) {
+    char text[1024];
+    size_t len = 0;
+    buffer[0]  = '\0';
+    if (cgroup->procs_fd < 0) {
+        return 0;
+    }
+
+    if (read_file(cgroup->path, "memory.peak", text, sizeof(text)) > 0) {
+        len += snprintf(buffer + len, size - len, " memory.peak=%lld", atoll(text));
+    }
+
+    if (read_file(cgroup->path, "cpu.stat", text, sizeof(text)) > 0) {
+        for (char *line = text; line && *line && len < size;) {
+            char *next = strchr(line, '\n');
+            if (next) {
+                *next++ = '\0';
+            }
+            char *space = strchr(line, ' ');
+            if (space) {
+                *space = '\0';
+                for (size_t i = 0; i < sizeof(cgroup_cpu_stats) / sizeof(cgroup_cpu_stats[0]) && len < size; i++) {
+                    if (strcmp(line, cgroup_cpu_stats[i]) == 0) {
+                        len += snprintf(buffer + len, size - len, " cpu.%s=%lld", line, atoll(space + 1));
+                    }
+                }
+            }
+            line = next;
+        }
+    }
+    return (len < size) ? len : size - 1;
+}
+
+// 运行结束后删除叶子；组内仍有进程时删除失败，保留该叶子
+void cgroup_destroy(cgroup_t *cgroup) {
+    if (cgroup->procs_fd < 0) {
+        return;
+    }
+    close(cgroup->procs_fd);
+    cgroup->procs_fd = -1;
+    rmdir(cgroup->path);
+}
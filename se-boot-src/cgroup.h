@@ -0,0 +1,40 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_CGROUP_H
+#define SE_BOOT_CGROUP_H
+
+#include <stddef.h>
+#include <limits.h>
+
+#define CGROUP_DEFAULT_ROOT "/sys/fs/cgroup/se-boot" // 可通过环境变量SE_CGROUP_ROOT修改（须位于cgroup2中）
+#define CGROUP_CONTROLS (6)
+#define CGROUP_VALUE_SIZE (32)
+
+// 一个服务的cgroup v2限制，values[i]为空串表示不设置，顺序同cgroup.c中的控制项表
+typedef struct cgroup_limits_t {
+    int enabled; // 即使没有设置限制也放入独立的cgroup（用于统计）
+    char values[CGROUP_CONTROLS][CGROUP_VALUE_SIZE];
+} cgroup_limits_t;
+
+// 一次运行所在的叶子cgroup
+typedef struct cgroup_t {
+    char path[PATH_MAX];
+    int procs_fd; // 叶子的cgroup.procs，子进程在exec前写入"0"加入；未使用cgroup时为-1
+} cgroup_t;
+
+int cgroup_limits_set(cgroup_limits_t *limits, const char *key, const char *value);
+size_t cgroup_limits_dump(const cgroup_limits_t *limits, char *buffer, size_t size);
+int cgroup_limits_used(const cgroup_limits_t *limits);
+
+int cgroup_create(cgroup_t *cgroup, const cgroup_limits_t *limits, const char *name, char *msg, size_t msg_size);
+int cgroup_enter(const cgroup_t *cgroup);
+size_t cgroup_stats(const cgroup_t *cgroup, char *buffer, size_t size);
+void cgroup_destroy(cgroup_t *cgroup);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
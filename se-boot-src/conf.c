@@ -0,0 +1,50 @@
+#include <stdlib.h>
+#include <ctype.h>
+#include "se-boot-src/conf.h"
+
+// 读取环境变量中的整数配置，未设置或格式错误时返回默认值
+long conf_long(const char *name, long def) {
+    const char *value = getenv(name);
+    if (!value || !*value) {
+        return def;
+    }
+
+    char *end;
+    long result = strtol(value, &end, 10);
+    if (end == value || *end != '\0') {
+        return def;
+    }
+    return result;
+}
+
+// 读取以字节为单位的配置，支持K/M/G后缀（例如 SE_LOG_MAX_SIZE=4M）
+long conf_size(const char *name, long def) {
+    const char *value = getenv(name);
+    if (!value || !*value) {
+        return def;
+    }
+
+    char *end;
+    long result = strtol(value, &end, 10);
+    if (end == value || result < 0) {
+        return def;
+    }
+
+    switch (toupper((unsigned char)*end)) {
+    case 'G':
+        result *= 1024;
+        // fall through
+    case 'M':
+        result *= 1024;
+        // fall through
+    case 'K':
+        result *= 1024;
+        end++;
+        break;
+    }
+
+    if (*end != '\0') {
+        return def;
+    }
+    return result;
+}
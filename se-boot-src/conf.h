@@ -0,0 +1,15 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_CONF_H
+#define SE_BOOT_CONF_H
+
+long conf_long(const char *name, long def);
+long conf_size(const char *name, long def);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,672 +1,575 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <time.h>
-#include <sys/time.h>
-#include <unistd.h>
-#include <fcntl.h>
-#include <sys/stat.h>
-#include <errno.h>
-#include <dirent.h>
-#include <sys/file.h>
-#include <getopt.h>
-#include "se-boot-src/log.h"
-#include "se-boot-src/path.h"
-
-#define SE_LOG_MAX_FILE_SIZE (1024 * 16)
-#define SE_LOG_MAX_MSG_SIZE (2048)
-#define SE_LOG_READ_BUFFER_SIZE (SE_LOG_MAX_FILE_SIZE * 3) // 10MB默认缓冲区
-
-#define LOG_FILTER_FLAG_ON_FIRST (1 << 0)
-#define LOG_FILTER_FLAG_exclude_timestamp (1 << 1)
-#define LOG_FILTER_FLAG_exclude_time (1 << 2)
-#define LOG_FILTER_FLAG_exclude_type (1 << 3)
-#define LOG_FILTER_FLAG_exclude_pid (1 << 4)
-#define LOG_FILTER_FLAG_exclude_path (1 << 5)
-#define LOG_FILTER_FLAG_exclude_name (1 << 6)
-#define LOG_FILTER_FLAG_human_time (1 << 7)
-#define LOG_FILTER_FLAG_human_type (1 << 8)
-
-extern const char *log_type_map[];
-
-typedef struct log_filter_t {
-    int filter_num;
-    int flag;
-
-    long filter_time_start;
-    long filter_time_end;
-
-    int *filter_type;
-    unsigned int filter_type_size;
-    int *filter_exclude_type;
-    unsigned int filter_exclude_type_size;
-
-    int *filter_pid;
-    unsigned int filter_pid_size;
-    int *filter_exclude_pid;
-    unsigned int filter_exclude_pid_size;
-
-    char **filter_path;
-    unsigned int filter_path_size;
-    char **filter_exclude_path;
-    unsigned int filter_exclude_path_size;
-
-    char **filter_name;
-    unsigned int filter_name_size;
-    char **filter_exclude_name;
-    unsigned int filter_exclude_name_size;
-} log_filter_t;
-
-const char *log_type_map[] = {"process", "boot"};
-
-// 获取当前时间戳（毫秒）
-static long get_timestamp() {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (long)tv.tv_sec * 1000 + tv.tv_usec / 1000;
-}
-
-// 将毫秒时间戳转换为可读时间格式
-static void timestamp_to_human(long timestamp, char *buffer, size_t buffer_size) {
-    time_t seconds     = timestamp / 1000;
-    long milliseconds  = timestamp % 1000;
-    struct tm *tm_info = localtime(&seconds);
-
-    strftime(buffer, buffer_size, "%Y-%m-%d %H:%M:%S", tm_info);
-    snprintf(buffer + strlen(buffer), buffer_size - strlen(buffer), ":%06ld", milliseconds * 1000);
-}
-
-// 获取文件大小
-long get_file_size(const char *filename) {
-    struct stat st;
-    if (stat(filename, &st) == 0) {
-        return st.st_size;
-    }
-    return -1;
-}
-
-// 获取日志文件锁
-static int lock_log_file(int fd) {
-    return flock(fd, LOCK_EX);
-}
-
-// 释放日志文件锁
-static int unlock_log_file(int fd) {
-    return flock(fd, LOCK_UN);
-}
-
-static int copy_file(const char *src, const char *dst) {
-    FILE *src_file = fopen(src, "r");
-    if (!src_file)
-        return -1;
-
-    FILE *dst_file = fopen(dst, "w");
-    if (!dst_file) {
-        fclose(src_file);
-        return -1;
-    }
-
-    char buffer[1024];
-    size_t bytes;
-    while ((bytes = fread(buffer, 1, sizeof(buffer), src_file)) > 0) {
-        fwrite(buffer, 1, bytes, dst_file);
-    }
-
-    fclose(src_file);
-    fclose(dst_file);
-    return 0;
-}
-
-int log_write(int type, int pid, const char *path, const char *name, const char *msg) {
-    int fd = open(SE_LOG, O_WRONLY | O_CREAT | O_APPEND, 0666);
-    if (fd < 0) {
-        return -1;
-    }
-
-    // 获取文件锁
-    if (lock_log_file(fd) < 0) {
-        close(fd);
-        return -1;
-    }
-
-    // 检查文件大小
-    long file_size = get_file_size(SE_LOG);
-    if (file_size > SE_LOG_MAX_FILE_SIZE) {
-        // 备份当前日志文件
-
-        if (copy_file(SE_LOG, SE_LOG_LAST) < 0){
-            close(fd);
-            unlock_log_file(fd);
-            return -1;
-        }
-
-        // 重新打开文件
-        close(fd);
-        fd = open(SE_LOG, O_WRONLY | O_CREAT | O_TRUNC, 0666);
-        if (fd < 0) {
-            unlock_log_file(fd);
-            return -1;
-        }
-    }
-
-    // 获取当前时间戳
-    long timestamp = get_timestamp();
-
-    // 构建日志消息
-    char log_msg[SE_LOG_MAX_MSG_SIZE];
-    int msg_len = snprintf(log_msg, sizeof(log_msg), "[%ld][%d][%d][%s][%s]:%s\n", timestamp, type, pid, path, name, msg);
-
-    // 如果消息过长，截断
-    if (msg_len >= sizeof(log_msg)) {
-        log_msg[sizeof(log_msg) - 2] = '\n';
-        log_msg[sizeof(log_msg) - 1] = '\0';
-    }
-
-    // 写入日志
-    ssize_t written = write(fd, log_msg, strlen(log_msg));
-
-    // 释放文件锁并关闭文件
-    unlock_log_file(fd);
-    close(fd);
-
-    return (written < 0) ? -1 : 0;
-}
-
-// 检查是否匹配过滤条件
-static int match_filter(const char *line, log_filter_t *filter) {
-    // 这里需要解析日志行并应用过滤条件
-    // 简化实现：假设所有字段都存在且格式正确
-    long timestamp;
-    int type, pid;
-    char path[256], name[256], msg[1024];
-
-    if (sscanf(line, "[%ld][%d][%d][%255[^][]][%255[^][]]:%1023[^\n]", &timestamp, &type, &pid, path, name, msg) != 6) {
-        return 0;
-    }
-
-    // 应用时间过滤
-    if (filter->filter_time_start > 0 && timestamp < filter->filter_time_start) {
-        return 0;
-    }
-    if (filter->filter_time_end > 0 && timestamp > filter->filter_time_end) {
-        return 0;
-    }
-
-    // 应用类型过滤
-    if (filter->filter_type_size > 0) {
-        int found = 0;
-        for (unsigned int i = 0; i < filter->filter_type_size; i++) {
-            if (type == filter->filter_type[i]) {
-                found = 1;
-                break;
-            }
-        }
-        if (!found)
-            return 0;
-    }
-
-    // 应用排除类型过滤
-    if (filter->filter_exclude_type_size > 0) {
-        for (unsigned int i = 0; i < filter->filter_exclude_type_size; i++) {
-            if (type == filter->filter_exclude_type[i]) {
-                return 0;
-            }
-        }
-    }
-
-    // 应用PID过滤
-    if (filter->filter_pid_size > 0) {
-        int found = 0;
-        for (unsigned int i = 0; i < filter->filter_pid_size; i++) {
-            if (pid == filter->filter_pid[i]) {
-                found = 1;
-                break;
-            }
-        }
-        if (!found)
-            return 0;
-    }
-
-    // 应用排除PID过滤
-    if (filter->filter_exclude_pid_size > 0) {
-        for (unsigned int i = 0; i < filter->filter_exclude_pid_size; i++) {
-            if (pid == filter->filter_exclude_pid[i]) {
-                return 0;
-            }
-        }
-    }
-
-    // 应用路径过滤
-    if (filter->filter_path_size > 0) {
-        int found = 0;
-        for (unsigned int i = 0; i < filter->filter_path_size; i++) {
-            if (strcmp(path, filter->filter_path[i]) == 0) {
-                found = 1;
-                break;
-            }
-        }
-        if (!found)
-            return 0;
-    }
-
-    // 应用排除路径过滤
-    if (filter->filter_exclude_path_size > 0) {
-        for (unsigned int i = 0; i < filter->filter_exclude_path_size; i++) {
-            if (strcmp(path, filter->filter_exclude_path[i]) == 0) {
-                return 0;
-            }
-        }
-    }
-
-    // 应用名称过滤
-    if (filter->filter_name_size > 0) {
-        int found = 0;
-        for (unsigned int i = 0; i < filter->filter_name_size; i++) {
-            if (strcmp(name, filter->filter_name[i]) == 0) {
-                found = 1;
-                break;
-            }
-        }
-        if (!found)
-            return 0;
-    }
-
-    // 应用排除名称过滤
-    if (filter->filter_exclude_name_size > 0) {
-        for (unsigned int i = 0; i < filter->filter_exclude_name_size; i++) {
-            if (strcmp(name, filter->filter_exclude_name[i]) == 0) {
-                return 0;
-            }
-        }
-    }
-
-    return 1;
-}
-
-// 格式化日志行
-static void format_log_line(char *dest, const char *src, log_filter_t *filter) {
-    long timestamp;
-    int type, pid;
-    char path[256], name[256], msg[1024];
-
-    if (sscanf(src, "[%ld][%d][%d][%255[^][]][%255[^][]]:%1023[^\n]", &timestamp, &type, &pid, path, name, msg) != 6) {
-        strcpy(dest, src);
-        return;
-    }
-
-    char human_time[32];
-    char output[SE_LOG_MAX_MSG_SIZE] = {0};
-    char temp[1200];
-
-    if (!(filter->flag & LOG_FILTER_FLAG_exclude_timestamp)) {
-        if (filter->flag & LOG_FILTER_FLAG_human_time) {
-            timestamp_to_human(timestamp, human_time, sizeof(human_time));
-            snprintf(temp, sizeof(temp), "[%s]", human_time);
-        } else {
-            snprintf(temp, sizeof(temp), "[%ld]", timestamp);
-        }
-        strcat(output, temp);
-    }
-
-    if (!(filter->flag & LOG_FILTER_FLAG_exclude_type)) {
-        if (filter->flag & LOG_FILTER_FLAG_human_type) {
-            snprintf(temp, sizeof(temp), "[%s]", log_type_map[type]);
-        } else {
-            snprintf(temp, sizeof(temp), "[%d]", type);
-        }
-        strcat(output, temp);
-    }
-
-    if (!(filter->flag & LOG_FILTER_FLAG_exclude_pid)) {
-        snprintf(temp, sizeof(temp), "[%d]", pid);
-        strcat(output, temp);
-    }
-
-    if (!(filter->flag & LOG_FILTER_FLAG_exclude_path)) {
-        snprintf(temp, sizeof(temp), "[%s]", path);
-        strcat(output, temp);
-    }
-
-    if (!(filter->flag & LOG_FILTER_FLAG_exclude_name)) {
-        snprintf(temp, sizeof(temp), "[%s]", name);
-        strcat(output, temp);
-    }
-
-    snprintf(temp, sizeof(temp), ":%s\n", msg);
-    strcat(output, temp);
-
-    strcpy(dest, output);
-}
-
-int log_read(char *buffer, unsigned int size, log_filter_t *filter) {
-    char line[SE_LOG_MAX_MSG_SIZE];
-    char formatted[SE_LOG_MAX_MSG_SIZE];
-    unsigned int total_written = 0;
-    int count                  = 0;
-
-    // 读取SE_LOG_LAST文件（如果存在）
-    FILE *file = fopen(SE_LOG_LAST, "rb");
-    if (file) {
-        while (fgets(line, sizeof(line), file)) {
-            if (match_filter(line, filter)) {
-                format_log_line(formatted, line, filter);
-                unsigned int len = strlen(formatted);
-
-                if (total_written + len >= size) {
-                    fclose(file);
-                    return -1; // 缓冲区不足
-                }
-
-                strcpy(buffer + total_written, formatted);
-                total_written += len;
-                count++;
-
-                if (filter->filter_num > 0 && count >= filter->filter_num) {
-                    fclose(file);
-                    return count;
-                }
-            }
-        }
-        fclose(file);
-    }
-
-    // 读取SE_LOG文件
-    file = fopen(SE_LOG, "r");
-    if (!file) {
-        return (count > 0) ? count : -1;
-    }
-
-    while (fgets(line, sizeof(line), file)) {
-        if (match_filter(line, filter)) {
-            format_log_line(formatted, line, filter);
-            unsigned int len = strlen(formatted);
-
-            if (total_written + len >= size) {
-                fclose(file);
-                return -1; // 缓冲区不足
-            }
-
-            strcpy(buffer + total_written, formatted);
-            total_written += len;
-            count++;
-
-            if (filter->filter_num > 0 && count >= filter->filter_num) {
-                break;
-            }
-        }
-    }
-
-    fclose(file);
-    return count;
-}
-
-static int parse_int_list(const char *str, int **result, unsigned int *count) {
-    if (!str || !*str)
-        return -1;
-
-    char *copy = strdup(str);
-    if (!copy)
-        return -1;
-
-    // 计算元素数量
-    *count = 1;
-    for (char *p = copy; *p; p++) {
-        if (*p == ',')
-            (*count)++;
-    }
-
-    // 分配内存
-    *result = malloc(*count * sizeof(int));
-    if (!*result) {
-        free(copy);
-        return -1;
-    }
-
-    // 解析每个元素
-    char *token = strtok(copy, ",");
-    for (unsigned int i = 0; i < *count && token; i++) {
-        (*result)[i] = atoi(token);
-        token        = strtok(NULL, ",");
-    }
-
-    free(copy);
-    return 0;
-}
-
-// 解析逗号分隔的字符串列表
-static int parse_str_list(const char *str, char ***result, unsigned int *count) {
-    if (!str || !*str)
-        return -1;
-
-    char *copy = strdup(str);
-    if (!copy)
-        return -1;
-
-    // 计算元素数量
-    *count = 1;
-    for (char *p = copy; *p; p++) {
-        if (*p == ',')
-            (*count)++;
-    }
-
-    // 分配内存
-    *result = malloc(*count * sizeof(char *));
-    if (!*result) {
-        free(copy);
-        return -1;
-    }
-
-    // 解析每个元素
-    char *token = strtok(copy, ",");
-    for (unsigned int i = 0; i < *count && token; i++) {
-        (*result)[i] = strdup(token);
-        token        = strtok(NULL, ",");
-    }
-
-    free(copy);
-    return 0;
-}
-
-// 释放字符串列表
-static void free_str_list(char **list, unsigned int count) {
-    if (!list)
-        return;
-    for (unsigned int i = 0; i < count; i++) {
-        free(list[i]);
-    }
-    free(list);
-}
-
-int log_read_main(int argc, char *argv[]) {
-
-
-    log_filter_t filter = {0};
-    char *output_file   = NULL;
-    int buffer_size     = SE_LOG_READ_BUFFER_SIZE;
-    char *buffer        = NULL;
-    FILE *output        = stdout;
-
-    // 定义长选项
-    static struct option long_options[] = {
-        {"start-time", required_argument, 0, 's'},
-        {"end-time", required_argument, 0, 'e'},
-        {"type", required_argument, 0, 't'},
-        {"exclude-type", required_argument, 0, 'x'},
-        {"pid", required_argument, 0, 'p'},
-        {"exclude-pid", required_argument, 0, 'X'},
-        {"path", required_argument, 0, 'P'},
-        {"exclude-path", required_argument, 0, 'E'},
-        {"name", required_argument, 0, 'n'},
-        {"exclude-name", required_argument, 0, 'N'},
-        {"count", required_argument, 0, 'c'},
-        {"human-time", no_argument, 0, 'H'},
-        {"no-timestamp", no_argument, 0, 0},
-        {"no-type", no_argument, 0, 0},
-        {"no-pid", no_argument, 0, 0},
-        {"no-path", no_argument, 0, 0},
-        {"no-name", no_argument, 0, 0},
-        {"output", required_argument, 0, 'o'},
-        {0, 0, 0, 0}};
-
-    int opt;
-    int option_index = 0;
-
-    while ((opt = getopt_long(argc, argv, "hs:e:t:x:p:X:P:E:n:N:c:Ho:", long_options, &option_index)) != -1) {
-        switch (opt) {
-            
-        case 's':
-            filter.filter_time_start = atol(optarg);
-            break;
-
-        case 'e':
-            filter.filter_time_end = atol(optarg);
-            break;
-
-        case 't':
-            if (parse_int_list(optarg, &filter.filter_type, &filter.filter_type_size) != 0) {
-                fprintf(stderr, "Failed to parse type list\n");
-                return 1;
-            }
-            break;
-
-        case 'x':
-            if (parse_int_list(optarg, &filter.filter_exclude_type, &filter.filter_exclude_type_size) != 0) {
-                fprintf(stderr, "Failed to parse exclude type list\n");
-                return 1;
-            }
-            break;
-
-        case 'p':
-            if (parse_int_list(optarg, &filter.filter_pid, &filter.filter_pid_size) != 0) {
-                fprintf(stderr, "Failed to parse PID list\n");
-                return 1;
-            }
-            break;
-
-        case 'X':
-            if (parse_int_list(optarg, &filter.filter_exclude_pid, &filter.filter_exclude_pid_size) != 0) {
-                fprintf(stderr, "Failed to parse exclude PID list\n");
-                return 1;
-            }
-            break;
-
-        case 'P':
-            if (parse_str_list(optarg, &filter.filter_path, &filter.filter_path_size) != 0) {
-                fprintf(stderr, "Failed to parse path list\n");
-                return 1;
-            }
-            break;
-
-        case 'E':
-            if (parse_str_list(optarg, &filter.filter_exclude_path, &filter.filter_exclude_path_size) != 0) {
-                fprintf(stderr, "Failed to parse exclude path list\n");
-                return 1;
-            }
-            break;
-
-        case 'n':
-            if (parse_str_list(optarg, &filter.filter_name, &filter.filter_name_size) != 0) {
-                fprintf(stderr, "Failed to parse name list\n");
-                return 1;
-            }
-            break;
-
-        case 'N':
-            if (parse_str_list(optarg, &filter.filter_exclude_name, &filter.filter_exclude_name_size) != 0) {
-                fprintf(stderr, "Failed to parse exclude name list\n");
-                return 1;
-            }
-            break;
-
-        case 'c':
-            filter.filter_num = atoi(optarg);
-            break;
-
-        case 'H':
-            filter.flag |= LOG_FILTER_FLAG_human_time;
-            break;
-
-        case 'o':
-            output_file = strdup(optarg);
-            break;
-
-        case 0:
-            // 处理无短选项的长选项
-            if (strcmp(long_options[option_index].name, "no-timestamp") == 0) {
-                filter.flag |= LOG_FILTER_FLAG_exclude_timestamp;
-            } else if (strcmp(long_options[option_index].name, "no-type") == 0) {
-                filter.flag |= LOG_FILTER_FLAG_exclude_type;
-            } else if (strcmp(long_options[option_index].name, "no-pid") == 0) {
-                filter.flag |= LOG_FILTER_FLAG_exclude_pid;
-            } else if (strcmp(long_options[option_index].name, "no-path") == 0) {
-                filter.flag |= LOG_FILTER_FLAG_exclude_path;
-            } else if (strcmp(long_options[option_index].name, "no-name") == 0) {
-                filter.flag |= LOG_FILTER_FLAG_exclude_name;
-            }
-            break;
-
-        default:
-            fprintf(stderr, "Unknown option. Use -h for help.\n");
-            return 1;
-        }
-    }
-
-    if (filter.filter_num == 0){
-        filter.filter_num = LOG_DEFAULT_COUNT;
-    }
-
-    // 分配缓冲区
-    buffer = malloc(buffer_size);
-    if (!buffer) {
-        fprintf(stderr, "Failed to allocate buffer\n");
-        goto cleanup;
-    }
-
-    // 打开输出文件
-    if (output_file) {
-        output = fopen(output_file, "w");
-        if (!output) {
-            fprintf(stderr, "Failed to open output file: %s\n", output_file);
-            goto cleanup;
-        }
-    }
-
-    // 读取日志
-    int count = log_read(buffer, buffer_size, &filter);
-    if (count < 0) {
-        fprintf(stderr, "Failed to read log\n");
-        goto cleanup;
-    }
-
-    // 输出结果
-    fwrite(buffer, 1, strlen(buffer), output);
-
-cleanup:
-    // 清理资源
-    if (buffer)
-        free(buffer);
-    if (output_file)
-        free(output_file);
-    if (output && output != stdout)
-        fclose(output);
-
-    if (filter.filter_type)
-        free(filter.filter_type);
-    if (filter.filter_exclude_type)
-        free(filter.filter_exclude_type);
-    if (filter.filter_pid)
-        free(filter.filter_pid);
-    if (filter.filter_exclude_pid)
-        free(filter.filter_exclude_pid);
-
-    if (filter.filter_path)
-        free_str_list(filter.filter_path, filter.filter_path_size);
-    if (filter.filter_exclude_path)
-        free_str_list(filter.filter_exclude_path, filter.filter_exclude_path_size);
-    if (filter.filter_name)
-        free_str_list(filter.filter_name, filter.filter_name_size);
-    if (filter.filter_exclude_name)
-        free_str_list(filter.filter_exclude_name, filter.filter_exclude_name_size);
-
-    return 0;
-}
\ No newline at end of file
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/file.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "se-boot-src/log.h"
+#include "se-boot-src/proc.h"
+#include "se-boot-src/path.h"
+#include "se-boot-src/log_ring.h"
+#include "se-boot-src/log_record.h"
+#include "se-boot-src/log_index.h"
+#include "se-boot-src/log_store.h"
+#include "se-boot-src/conf.h"
+
+#define SE_LOG_MAX_FILE_SIZE (1024 * 16) // 默认轮转大小
+#define SE_LOG_DEFAULT_GENERATIONS (1)
+#define SE_LOG_MAX_GENERATIONS (999)
+#define LOG_SEND_TIMEOUT (1) // 发送到聚合进程的超时秒数
+
+// 获取当前时间戳（毫秒）
+static long get_timestamp() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (long)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+// 获取文件大小
+long get_file_size(const char *filename) {
+    struct stat st;
+    if (stat(filename, &st) == 0) {
+        return st.st_size;
+    }
+    return -1;
+}
+
+// 获取日志文件锁
+static int lock_log_file(int fd) {
+    return flock(fd, LOCK_EX);
+}
+
+// 释放日志文件锁
+static int unlock_log_file(int fd) {
+    return flock(fd, LOCK_UN);
+}
+
+// 是否按服务名将日志写入各自的分片，可通过环境变量SE_LOG_SHARD=1开启
+int log_shard() {
+    static int shard = -1;
+    if (shard < 0) {
+        shard = conf_long("SE_LOG_SHARD", 0) != 0;
+    }
+    return shard;
+}
+
+// 服务name的分片日志文件路径，文件名中只保留字母、数字和"._-"，其余替换为'_'
+void log_shard_path(const char *name, char *buffer, size_t size) {
+    char file[128];
+    size_t len = 0;
+
+    for (; name[len] && len < sizeof(file) - 1; len++) {
+        char c = name[len];
+        int ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '.' || c == '_' || c == '-';
+        file[len] = ok ? c : '_';
+    }
+    file[len] = '\0';
+
+    // 避免隐藏文件以及"."、".."
+    if (len == 0 || file[0] == '.') {
+        memmove(file + 1, file, (len < sizeof(file) - 2 ? len : sizeof(file) - 2) + 1);
+        file[0] = '_';
+        file[sizeof(file) - 1] = '\0';
+    }
+
+    snprintf(buffer, size, "%s/%s.log", SE_LOG_SHARD_DIR, file);
+}
+
+// 重新打开写入器的日志文件，并记录其inode用于检测轮转
+static int writer_reopen(log_writer_t *writer) {
+    if (writer->fd >= 0) {
+        close(writer->fd);
+    }
+    if (writer->idx_fd >= 0) {
+        close(writer->idx_fd);
+        writer->idx_fd = -1;
+    }
+
+    // 开启分片时每个服务写入各自的文件，各持一把锁，互不等待、互不轮转对方的日志
+    if (!writer->file[0]) {
+        if (log_shard()) {
+            log_shard_path(writer->name, writer->file, sizeof(writer->file));
+        } else {
+            snprintf(writer->file, sizeof(writer->file), "%s", SE_LOG);
+        }
+    }
+
+    writer->fd = open(writer->file, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0666);
+    if (writer->fd < 0 && errno == ENOENT && mkdir(SE_LOG_SHARD_DIR, 0777) == 0) {
+        writer->fd = open(writer->file, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0666);
+    }
+    if (writer->fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(writer->fd, &st) < 0) {
+        close(writer->fd);
+        writer->fd = -1;
+        return -1;
+    }
+
+    writer->dev = st.st_dev;
+    writer->ino = st.st_ino;
+    return 0;
+}
+
+// 锁定当前日志文件，若持有的fd已不是该路径上的文件（被轮转替换）则重新打开
+// 成功返回时st为当前日志文件的状态
+static int writer_lock(log_writer_t *writer, struct stat *st) {
+    for (int retry = 0; retry < 8; retry++) {
+        if (writer->fd < 0 && writer_reopen(writer) < 0) {
+            return -1;
+        }
+
+        if (lock_log_file(writer->fd) < 0) {
+            return -1;
+        }
+
+        if (stat(writer->file, st) == 0 && st->st_dev == writer->dev && st->st_ino == writer->ino) {
+            return 0;
+        }
+
+        unlock_log_file(writer->fd);
+        close(writer->fd);
+        writer->fd = -1;
+    }
+
+    return -1;
+}
+
+// 日志文件轮转大小，可通过环境变量SE_LOG_MAX_SIZE设置（支持K/M/G后缀）
+static long log_max_size() {
+    static long max_size = -1;
+    if (max_size < 0) {
+        max_size = conf_size("SE_LOG_MAX_SIZE", SE_LOG_MAX_FILE_SIZE);
+        if (max_size <= 0) {
+            max_size = SE_LOG_MAX_FILE_SIZE;
+        }
+    }
+    return max_size;
+}
+
+// 保留的历史日志代数（se_boot.log.1 ... se_boot.log.N），可通过环境变量SE_LOG_GENERATIONS设置
+int log_generations() {
+    static int generations = -1;
+    if (generations < 0) {
+        generations = conf_long("SE_LOG_GENERATIONS", SE_LOG_DEFAULT_GENERATIONS);
+        if (generations < 0 || generations > SE_LOG_MAX_GENERATIONS) {
+            generations = SE_LOG_DEFAULT_GENERATIONS;
+        }
+    }
+    return generations;
+}
+
+// 以base为当前日志文件（SE_LOG或某个分片）的第gen代日志文件路径，0为当前日志文件
+void log_gen_path(const char *base, int gen, char *buffer, size_t size) {
+    if (gen == 0) {
+        snprintf(buffer, size, "%s", base);
+    } else {
+        snprintf(buffer, size, "%s.%d", base, gen);
+    }
+}
+
+// 当前存在的最旧一代编号，读取时不依赖写入端的SE_LOG_GENERATIONS配置
+int log_gen_last(const char *base) {
+    char path[PATH_MAX];
+    int gen = 0;
+
+    while (gen < SE_LOG_MAX_GENERATIONS) {
+        log_gen_path(base, gen + 1, path, sizeof(path));
+        if (access(path, F_OK) < 0) {
+            // 历史日志可能已被压缩
+            strcat(path, LOG_ARCHIVE_SUFFIX);
+            if (access(path, F_OK) < 0) {
+                break;
+            }
+        }
+        gen++;
+    }
+    return gen;
+}
+
+// 在持有锁的情况下检查文件大小，超出则通过重命名轮转
+// 各代依次后移（.N-1 -> .N, ..., 当前日志文件 -> .1），耗时与日志大小无关
+// 轮转后重新打开并锁定新的当前日志文件，返回1表示轮转出的日志需要压缩
+static int writer_rotate(log_writer_t *writer, struct stat *st) {
+    if (st->st_size <= log_max_size()) {
+        return 0;
+    }
+
+    int generations = log_generations();
+    off_t size      = st->st_size;
+    char src[PATH_MAX];
+    char dst[PATH_MAX];
+
+    if (generations == 0) {
+        unlink(writer->file);
+        snprintf(src, sizeof(src), "%s.idx", writer->file);
+        unlink(src);
+    } else {
+        // 最旧的一代可能是普通文件或压缩文件，先删除，避免与后移过来的另一种格式并存
+        log_gen_path(writer->file, generations, dst, sizeof(dst));
+        size_t len = strlen(dst);
+        unlink(dst);
+        strcat(dst, LOG_ARCHIVE_SUFFIX);
+        unlink(dst);
+        strcpy(dst + len, ".idx");
+        unlink(dst);
+
+        for (int gen = generations - 1; gen >= 0; gen--) {
+            log_gen_path(writer->file, gen, src, sizeof(src));
+            log_gen_path(writer->file, gen + 1, dst, sizeof(dst));
+            if (rename(src, dst) < 0 && errno != ENOENT) {
+                return -1;
+            }
+
+            // 压缩文件、索引与日志文件一起后移
+            size_t src_len = strlen(src);
+            size_t dst_len = strlen(dst);
+            strcat(src, LOG_ARCHIVE_SUFFIX);
+            strcat(dst, LOG_ARCHIVE_SUFFIX);
+            rename(src, dst);
+
+            strcpy(src + src_len, ".idx");
+            strcpy(dst + dst_len, ".idx");
+            rename(src, dst);
+        }
+    }
+
+    // 等待锁的其他写入者会发现日志文件的inode已变化并重新打开
+    unlock_log_file(writer->fd);
+    close(writer->fd);
+    writer->fd = -1;
+
+    if (writer_lock(writer, st) < 0) {
+        return -1;
+    }
+    // 不足一个压缩块的小文件压缩收益很小，不值得为此创建进程
+    return (generations > 0 && size >= LOG_ARCHIVE_BLOCK_SIZE) ? 1 : 0;
+}
+
+// 是否压缩轮转出的历史日志，可通过环境变量SE_LOG_COMPRESS=0关闭
+static int log_compress() {
+    static int compress = -1;
+    if (compress < 0) {
+        compress = conf_long("SE_LOG_COMPRESS", 1) != 0;
+    }
+    return compress;
+}
+
+// 将base的第1代日志压缩为.slz，完成后在锁内找到该文件当前所在的代（压缩期间可能再次轮转），
+// 先放入压缩文件再删除原文件，读取者任何时候都能找到其中之一
+static void log_archive_run(const char *base) {
+    char src[PATH_MAX];
+    char tmp[PATH_MAX];
+    struct stat st;
+    struct stat cur;
+
+    log_gen_path(base, 1, src, sizeof(src));
+    int fd = open(src, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return;
+    }
+
+    snprintf(tmp, sizeof(tmp), "%s.%d%s.tmp", base, getpid(), LOG_ARCHIVE_SUFFIX);
+    int ret = log_archive_create(fd, tmp);
+    close(fd);
+    if (ret < 0) {
+        return;
+    }
+
+    log_writer_t writer = {.fd = -1, .idx_fd = -1};
+    snprintf(writer.file, sizeof(writer.file), "%s", base);
+    if (writer_lock(&writer, &cur) < 0) {
+        unlink(tmp);
+        return;
+    }
+
+    int generations = log_generations();
+    int gen         = 1;
+    for (; gen <= generations; gen++) {
+        log_gen_path(base, gen, src, sizeof(src));
+        if (stat(src, &cur) == 0 && cur.st_dev == st.st_dev && cur.st_ino == st.st_ino) {
+            break;
+        }
+    }
+
+    if (gen <= generations) {
+        size_t len = strlen(src);
+        strcat(src, LOG_ARCHIVE_SUFFIX);
+        rename(tmp, src);
+
+        src[len] = '\0';
+        unlink(src);
+        strcat(src, ".idx");
+        unlink(src);
+    } else {
+        // 已被轮转删除
+        unlink(tmp);
+    }
+
+    unlock_log_file(writer.fd);
+    close(writer.fd);
+}
+
+// 在后台压缩刚轮转出的日志，两次fork使压缩进程脱离调用者，不影响其等待子进程
+static void log_archive_spawn(const char *base) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        return;
+    }
+    if (pid > 0) {
+        waitpid(pid, NULL, 0);
+        return;
+    }
+
+    if (fork() != 0) {
+        _exit(0);
+    }
+
+    // 不能持有调用者的管道等fd，否则会影响其检测EOF
+    close_fds(0);
+    log_reset();
+    log_archive_run(base);
+    _exit(0);
+}
+
+// 以写入器的属性和当前时间构建记录
+static void writer_record(log_writer_t *writer, log_record_t *record) {
+    record->timestamp = get_timestamp();
+    record->type      = writer->type;
+    record->pid       = writer->pid;
+    record->path      = writer->path;
+    record->path_len  = strlen(writer->path);
+    record->name      = writer->name;
+    record->name_len  = strlen(writer->name);
+}
+
+int log_writer_open(log_writer_t *writer, int type, int pid, const char *path, const char *name) {
+    writer->fd     = -1;
+    writer->idx_fd = -1;
+    writer->dev    = 0;
+    writer->ino    = 0;
+    writer->type   = type;
+    writer->pid    = pid;
+    writer->path   = path;
+    writer->name   = name;
+    writer->file[0] = '\0';
+
+    return writer_reopen(writer);
+}
+
+void log_writer_close(log_writer_t *writer) {
+    if (writer->fd >= 0) {
+        close(writer->fd);
+        writer->fd = -1;
+    }
+    if (writer->idx_fd >= 0) {
+        close(writer->idx_fd);
+        writer->idx_fd = -1;
+    }
+}
+
+// 日志写入进程自身（聚合进程/日志环消费者）直接写文件，不再经过套接字或日志环
+static int log_direct = 0;
+
+void log_set_direct(int direct) {
+    log_direct = direct;
+}
+
+// 发送给聚合进程的套接字，首次发送时创建
+static int sock_fd = -1;
+
+// 调用者关闭了所有fd（close_fds）后丢弃缓存的套接字，不再close，以免该fd号已被复用
+void log_reset() {
+    sock_fd = -1;
+}
+
+// 通过聚合进程的Unix套接字发送已格式化的记录，聚合进程未运行时返回-1
+static int log_send(const struct iovec *iov, int count) {
+    static struct sockaddr_un addr;
+
+    size_t total = 0;
+    for (int i = 0; i < count; i++) {
+        total += iov[i].iov_len;
+    }
+    if (total > LOG_SEND_MAX_SIZE) {
+        return -1;
+    }
+
+    if (sock_fd < 0) {
+        sock_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (sock_fd < 0) {
+            return -1;
+        }
+
+        // 聚合进程卡住时不无限阻塞，超时后退回文件锁方式
+        struct timeval timeout = {LOG_SEND_TIMEOUT, 0};
+        setsockopt(sock_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, SE_LOG_SOCK, sizeof(addr.sun_path) - 1);
+    }
+
+    struct msghdr msg = {0};
+    msg.msg_name      = &addr;
+    msg.msg_namelen   = sizeof(addr);
+    msg.msg_iov       = (struct iovec *)iov;
+    msg.msg_iovlen    = count;
+
+    if (sendmsg(sock_fd, &msg, MSG_NOSIGNAL) >= 0) {
+        return 0;
+    }
+
+    // 超时或被信号中断时保留套接字，其他错误下次重新创建；
+    // fd已不是本模块的套接字（已被关闭或fd号被复用）时只丢弃，不能close以免误关其他文件
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        int err = errno;
+        if (err != EBADF && err != ENOTSOCK && err != EISCONN) {
+            close(sock_fd);
+        }
+        sock_fd = -1;
+        errno   = err;
+    }
+    return -1;
+}
+
+// 在锁内直接追加已格式化的记录
+static int writer_append(log_writer_t *writer, const struct iovec *iov, int count) {
+    struct stat st;
+    if (writer_lock(writer, &st) < 0) {
+        return -1;
+    }
+
+    // 检查文件大小，轮转失败时仍持有锁；轮转后重新加锁失败时已不持有锁
+    int rotated = writer_rotate(writer, &st);
+    if (rotated < 0) {
+        if (writer->fd >= 0) {
+            unlock_log_file(writer->fd);
+        }
+        return -1;
+    }
+
+    ssize_t written = writev(writer->fd, iov, count);
+    if (written > 0 && count > 0) {
+        log_index_append(&writer->idx_fd, writer->file, writer->ino, st.st_size, written, iov[0].iov_base, iov[0].iov_len);
+    }
+
+    unlock_log_file(writer->fd);
+
+    if (rotated > 0 && log_compress()) {
+        log_archive_spawn(writer->file);
+    }
+    return (written < 0) ? -1 : 0;
+}
+
+// 优先交给聚合进程写入，否则走文件锁
+// 分片时各服务的锁互不竞争，直接写入，聚合进程与日志环只用于共用SE_LOG的情况
+static int writer_flush(log_writer_t *writer, const struct iovec *iov, int count) {
+    if (!log_direct && !log_shard() && log_send(iov, count) == 0) {
+        return 0;
+    }
+    return writer_append(writer, iov, count);
+}
+
+int log_writer_append(log_writer_t *writer, const struct iovec *iov, int count) {
+    return writer_append(writer, iov, count);
+}
+
+int log_writer_write(log_writer_t *writer, char *buffer, size_t size) {
+    char batch[LOG_SEND_MAX_SIZE];
+    size_t batch_len = 0;
+    int format       = log_record_format();
+    int ret          = 0;
+    int spill        = log_direct || log_shard();
+    log_record_t record;
+
+    // 同一次read得到的行使用相同的时间戳
+    writer_record(writer, &record);
+
+    char *line = buffer;
+    char *end  = buffer + size;
+
+    while (line < end) {
+        char *next = memchr(line, '\n', end - line);
+        if (!next) {
+            next = end;
+        }
+
+        size_t len = next - line;
+        for (size_t i = 0; i < len; i++) {
+            if (line[i] == '\r' || line[i] == '\0') {
+                line[i] = ' ';
+            }
+        }
+
+        if (len > 0) {
+            record.msg     = line;
+            record.msg_len = len;
+
+            char *encoded      = batch + batch_len;
+            size_t encoded_len = log_record_encode(encoded, &record, format);
+
+            // 优先放入共享内存日志环，失败（未启用或已满）后本次剩余的行都批量写出，保持行的先后顺序
+            struct iovec iov = {encoded, encoded_len};
+            if (spill || log_ring_push(&iov, 1) < 0) {
+                spill = 1;
+                batch_len += encoded_len;
+            }
+
+            if (batch_len + LOG_RECORD_MAX_SIZE > sizeof(batch)) {
+                struct iovec flush = {batch, batch_len};
+                if (writer_flush(writer, &flush, 1) < 0) {
+                    ret = -1;
+                }
+                batch_len = 0;
+            }
+        }
+
+        line = next + 1;
+    }
+
+    if (batch_len > 0) {
+        struct iovec flush = {batch, batch_len};
+        if (writer_flush(writer, &flush, 1) < 0) {
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+int log_write(int type, int pid, const char *path, const char *name, const char *msg) {
+    log_writer_t writer = {.fd = -1, .idx_fd = -1, .type = type, .pid = pid, .path = path, .name = name};
+    log_record_t record;
+
+    // 构建日志消息，过长时截断
+    char log_msg[LOG_RECORD_MAX_SIZE];
+    writer_record(&writer, &record);
+    record.msg     = msg;
+    record.msg_len = strlen(msg);
+
+    struct iovec iov = {log_msg, log_record_encode(log_msg, &record, log_record_format())};
+    if (!log_direct && !log_shard() && (log_ring_push(&iov, 1) == 0 || log_send(&iov, 1) == 0)) {
+        return 0;
+    }
+
+    // 聚合进程未运行，直接写入文件
+    int ret = writer_append(&writer, &iov, 1);
+    log_writer_close(&writer);
+    return ret;
+}
@@ -1,24 +1,51 @@
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-#ifndef SE_BOOT_LOG_H
-#define SE_BOOT_LOG_H
-
-#include <sys/types.h>
-
-
-#define LOG_TYPE_PROCESS 0
-#define LOG_TYPE_BOOT 1
-#define LOG_DEFAULT_COUNT 30
-
-
-
-int log_write(int type, int pid, const char *path, const char *name, const char *msg);
-int log_read_main(int argc, char *argv[]);
-
-#endif
-
-#ifdef __cplusplus
-}
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_LOG_H
+#define SE_BOOT_LOG_H
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+
+#define LOG_TYPE_PROCESS 0
+#define LOG_TYPE_BOOT 1
+#define LOG_TYPE_STDERR 2 // 后台程序的stderr输出，stdout仍为LOG_TYPE_PROCESS
+#define LOG_DEFAULT_COUNT 30
+#define LOG_SEND_MAX_SIZE (64 * 1024) // 发送给聚合进程的单个数据报上限
+
+// 长期持有日志fd的批量写入器，供process_run等持续输出的场景使用
+typedef struct log_writer_t {
+    int fd;
+    int idx_fd; // 稀疏时间索引，随fd一起重新打开
+    dev_t dev;
+    ino_t ino;
+
+    int type;
+    int pid;
+    const char *path;
+    const char *name;
+    char file[256]; // 写入的日志文件：SE_LOG或该服务的分片，首次打开时确定
+} log_writer_t;
+
+int log_writer_open(log_writer_t *writer, int type, int pid, const char *path, const char *name);
+int log_writer_write(log_writer_t *writer, char *buffer, size_t size);
+int log_writer_append(log_writer_t *writer, const struct iovec *iov, int count);
+void log_writer_close(log_writer_t *writer);
+
+void log_set_direct(int direct);
+void log_reset();
+int log_generations();
+int log_shard();
+void log_shard_path(const char *name, char *buffer, size_t size);
+int log_gen_last(const char *base);
+void log_gen_path(const char *base, int gen, char *buffer, size_t size);
+int log_write(int type, int pid, const char *path, const char *name, const char *msg);
+int log_read_main(int argc, char *argv[]);
+
+#endif
+
+#ifdef __cplusplus
+}
 #endif
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include <stdlib.h>
+#include <string.h>
+#include "se-boot-src/log_filter.h"
+
+// 过滤条件在log_read_main中编译为执行计划：
+// 每个列表转换为哈希集合，查找耗时与列表长度无关；
+// 只加入用到的条件，按代价排序（时间 < 整数集合 < 字符串集合），同类中包含条件先于排除条件，
+// 包含条件通常排除掉大部分记录，尽早返回
+
+static unsigned int set_capacity(unsigned int count) {
+    unsigned int capacity = 8;
+    while (capacity < count * 2) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+static uint32_t hash_int(int key) {
+    uint32_t h = (uint32_t)key * 0x9e3779b1u;
+    return h ^ (h >> 16);
+}
+
+// FNV-1a
+static uint32_t hash_str(const char *str, unsigned int len) {
+    uint32_t h = 2166136261u;
+    for (unsigned int i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)str[i]) * 16777619u;
+    }
+    return h;
+}
+
+static int int_set_init(log_int_set_t *set, const int *list, unsigned int count) {
+    unsigned int capacity = set_capacity(count);
+
+    set->keys = malloc(capacity * sizeof(int));
+    set->used = calloc(capacity, 1);
+    set->mask = capacity - 1;
+    if (!set->keys || !set->used) {
+        return -1;
+    }
+
+    for (unsigned int i = 0; i < count; i++) {
+        unsigned int slot = hash_int(list[i]) & set->mask;
+        while (set->used[slot] && set->keys[slot] != list[i]) {
+            slot = (slot + 1) & set->mask;
+        }
+        set->keys[slot] = list[i];
+        set->used[slot] = 1;
+    }
+    return 0;
+}
+
+static int int_set_has(const log_int_set_t *set, int key) {
+    unsigned int slot = hash_int(key) & set->mask;
+    while (set->used[slot]) {
+        if (set->keys[slot] == key) {
+            return 1;
+        }
+        slot = (slot + 1) & set->mask;
+    }
+    return 0;
+}
+
+static void int_set_free(log_int_set_t *set) {
+    free(set->keys);
+    free(set->used);
+    set->keys = NULL;
+    set->used = NULL;
+}
+
+static int str_set_init(log_str_set_t *set, char **list, unsigned int count) {
+    unsigned int capacity = set_capacity(count);
+
+    set->keys   = calloc(capacity, sizeof(char *));
+    set->lens   = malloc(capacity * sizeof(unsigned int));
+    set->hashes = malloc(capacity * sizeof(uint32_t));
+    set->mask   = capacity - 1;
+    if (!set->keys || !set->lens || !set->hashes) {
+        return -1;
+    }
+
+    for (unsigned int i = 0; i < count; i++) {
+        unsigned int len  = strlen(list[i]);
+        uint32_t hash     = hash_str(list[i], len);
+        unsigned int slot = hash & set->mask;
+        while (set->keys[slot] && !(set->lens[slot] == len && memcmp(set->keys[slot], list[i], len) == 0)) {
+            slot = (slot + 1) & set->mask;
+        }
+        set->keys[slot]   = list[i];
+        set->lens[slot]   = len;
+        set->hashes[slot] = hash;
+    }
+    return 0;
+}
+
+static int str_set_has(const log_str_set_t *set, const char *str, unsigned int len) {
+    uint32_t hash     = hash_str(str, len);
+    unsigned int slot = hash & set->mask;
+    while (set->keys[slot]) {
+        if (set->hashes[slot] == hash && set->lens[slot] == len && memcmp(set->keys[slot], str, len) == 0) {
+            return 1;
+        }
+        slot = (slot + 1) & set->mask;
+    }
+    return 0;
+}
+
+static void str_set_free(log_str_set_t *set) {
+    free(set->keys);
+    free(set->lens);
+    free(set->hashes);
+    set->keys   = NULL;
+    set->lens   = NULL;
+    set->hashes = NULL;
+}
+
+static int step_time(const log_filter_t *filter, const log_record_t *record) {
+    if (filter->filter_time_start > 0 && record->timestamp < filter->filter_time_start) {
+        return 0;
+    }
+    if (filter->filter_time_end > 0 && record->timestamp > filter->filter_time_end) {
+        return 0;
+    }
+    return 1;
+}
+
+static int step_type(const log_filter_t *filter, const log_record_t *record) {
+    return int_set_has(&filter->type_set, record->type);
+}
+
+static int step_exclude_type(const log_filter_t *filter, const log_record_t *record) {
+    return !int_set_has(&filter->exclude_type_set, record->type);
+}
+
+static int step_pid(const log_filter_t *filter, const log_record_t *record) {
+    return int_set_has(&filter->pid_set, record->pid);
+}
+
+static int step_exclude_pid(const log_filter_t *filter, const log_record_t *record) {
+    return !int_set_has(&filter->exclude_pid_set, record->pid);
+}
+
+static int step_name(const log_filter_t *filter, const log_record_t *record) {
+    return str_set_has(&filter->name_set, record->name, record->name_len);
+}
+
+static int step_exclude_name(const log_filter_t *filter, const log_record_t *record) {
+    return !str_set_has(&filter->exclude_name_set, record->name, record->name_len);
+}
+
+static int step_path(const log_filter_t *filter, const log_record_t *record) {
+    return str_set_has(&filter->path_set, record->path, record->path_len);
+}
+
+static int step_exclude_path(const log_filter_t *filter, const log_record_t *record) {
+    return !str_set_has(&filter->exclude_path_set, record->path, record->path_len);
+}
+
+int log_filter_compile(log_filter_t *filter) {
+    filter->step_count = 0;
+
+    if (filter->filter_time_start > 0 || filter->filter_time_end > 0) {
+        filter->steps[filter->step_count++] = step_time;
+    }
+
+    // 整数集合
+    if (filter->filter_pid_size > 0) {
+        if (int_set_init(&filter->pid_set, filter->filter_pid, filter->filter_pid_size) < 0) {
+            return -1;
+        }
+        filter->steps[filter->step_count++] = step_pid;
+    }
+    if (filter->filter_type_size > 0) {
+        if (int_set_init(&filter->type_set, filter->filter_type, filter->filter_type_size) < 0) {
+            return -1;
+        }
+        filter->steps[filter->step_count++] = step_type;
+    }
+    if (filter->filter_exclude_pid_size > 0) {
+        if (int_set_init(&filter->exclude_pid_set, filter->filter_exclude_pid, filter->filter_exclude_pid_size) < 0) {
+            return -1;
+        }
+        filter->steps[filter->step_count++] = step_exclude_pid;
+    }
+    if (filter->filter_exclude_type_size > 0) {
+        if (int_set_init(&filter->exclude_type_set, filter->filter_exclude_type, filter->filter_exclude_type_size) < 0) {
+            return -1;
+        }
+        filter->steps[filter->step_count++] = step_exclude_type;
+    }
+
+    // 字符串集合，名称比路径短，先比较名称
+    if (filter->filter_name_size > 0) {
+        if (str_set_init(&filter->name_set, filter->filter_name, filter->filter_name_size) < 0) {
+            return -1;
+        }
+        filter->steps[filter->step_count++] = step_name;
+    }
+    if (filter->filter_path_size > 0) {
+        if (str_set_init(&filter->path_set, filter->filter_path, filter->filter_path_size) < 0) {
+            return -1;
+        }
+        filter->steps[filter->step_count++] = step_path;
+    }
+    if (filter->filter_exclude_name_size > 0) {
+        if (str_set_init(&filter->exclude_name_set, filter->filter_exclude_name, filter->filter_exclude_name_size) < 0) {
+            return -1;
+        }
+        filter->steps[filter->step_count++] = step_exclude_name;
+    }
+    if (filter->filter_exclude_path_size > 0) {
+        if (str_set_init(&filter->exclude_path_set, filter->filter_exclude_path, filter->filter_exclude_path_size) < 0) {
+            return -1;
+        }
+        filter->steps[filter->step_count++] = step_exclude_path;
+    }
+
+    return 0;
+}
+
+int log_filter_match(const log_filter_t *filter, const log_record_t *record) {
+    for (int i = 0; i < filter->step_count; i++) {
+        if (!filter->steps[i](filter, record)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void free_str_list(char **list, unsigned int count) {
+    if (!list)
+        return;
+    for (unsigned int i = 0; i < count; i++) {
+        free(list[i]);
+    }
+    free(list);
+}
+
+// 释放过滤条件的各列表及编译生成的集合
+void log_filter_free(log_filter_t *filter) {
+    int_set_free(&filter->type_set);
+    int_set_free(&filter->exclude_type_set);
+    int_set_free(&filter->pid_set);
+    int_set_free(&filter->exclude_pid_set);
+    str_set_free(&filter->path_set);
+    str_set_free(&filter->exclude_path_set);
+    str_set_free(&filter->name_set);
+    str_set_free(&filter->exclude_name_set);
+
+    free(filter->filter_type);
+    free(filter->filter_exclude_type);
+    free(filter->filter_pid);
+    free(filter->filter_exclude_pid);
+
+    free_str_list(filter->filter_path, filter->filter_path_size);
+    free_str_list(filter->filter_exclude_path, filter->filter_exclude_path_size);
+    free_str_list(filter->filter_name, filter->filter_name_size);
+    free_str_list(filter->filter_exclude_name, filter->filter_exclude_name_size);
+}
@@ -0,0 +1,89 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_LOG_FILTER_H
+#define SE_BOOT_LOG_FILTER_H
+
+#include <stdint.h>
+#include "se-boot-src/log_record.h"
+
+#define LOG_FILTER_FLAG_ON_FIRST (1 << 0)
+#define LOG_FILTER_FLAG_exclude_timestamp (1 << 1)
+#define LOG_FILTER_FLAG_exclude_time (1 << 2)
+#define LOG_FILTER_FLAG_exclude_type (1 << 3)
+#define LOG_FILTER_FLAG_exclude_pid (1 << 4)
+#define LOG_FILTER_FLAG_exclude_path (1 << 5)
+#define LOG_FILTER_FLAG_exclude_name (1 << 6)
+#define LOG_FILTER_FLAG_human_time (1 << 7)
+#define LOG_FILTER_FLAG_human_type (1 << 8)
+
+#define LOG_FILTER_MAX_STEPS (9)
+
+// 开放寻址哈希集合，容量为2的幂
+typedef struct log_int_set_t {
+    int *keys;
+    unsigned char *used;
+    unsigned int mask;
+} log_int_set_t;
+
+typedef struct log_str_set_t {
+    const char **keys;
+    unsigned int *lens;
+    uint32_t *hashes;
+    unsigned int mask;
+} log_str_set_t;
+
+struct log_filter_t;
+typedef int (*log_filter_step_t)(const struct log_filter_t *filter, const log_record_t *record);
+
+typedef struct log_filter_t {
+    int filter_num;
+    int flag;
+
+    long filter_time_start;
+    long filter_time_end;
+
+    int *filter_type;
+    unsigned int filter_type_size;
+    int *filter_exclude_type;
+    unsigned int filter_exclude_type_size;
+
+    int *filter_pid;
+    unsigned int filter_pid_size;
+    int *filter_exclude_pid;
+    unsigned int filter_exclude_pid_size;
+
+    char **filter_path;
+    unsigned int filter_path_size;
+    char **filter_exclude_path;
+    unsigned int filter_exclude_path_size;
+
+    char **filter_name;
+    unsigned int filter_name_size;
+    char **filter_exclude_name;
+    unsigned int filter_exclude_name_size;
+
+    // 由log_filter_compile生成的执行计划，只包含用到的条件
+    log_filter_step_t steps[LOG_FILTER_MAX_STEPS];
+    int step_count;
+
+    log_int_set_t type_set;
+    log_int_set_t exclude_type_set;
+    log_int_set_t pid_set;
+    log_int_set_t exclude_pid_set;
+    log_str_set_t path_set;
+    log_str_set_t exclude_path_set;
+    log_str_set_t name_set;
+    log_str_set_t exclude_name_set;
+} log_filter_t;
+
+int log_filter_compile(log_filter_t *filter);
+int log_filter_match(const log_filter_t *filter, const log_record_t *record);
+void log_filter_free(log_filter_t *filter);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,249 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "se-boot-src/log_index.h"
+#include "se-boot-src/log_record.h"
+#include "se-boot-src/conf.h"
+#include "se-boot-src/path.h"
+
+// 稀疏时间索引：每个日志文件旁有一个"<日志文件>.idx"，
+// 写入端每跨过SE_LOG_INDEX_INTERVAL字节追加一项(时间戳, 偏移)，随日志一起轮转
+#define LOG_INDEX_MAGIC (0x58444953) // "SIDX"
+#define LOG_INDEX_DEFAULT_INTERVAL (64 * 1024)
+
+// 不同进程的时间戳在取得锁之前生成，文件中的记录并非严格有序，
+// 查询时将时间边界向外放宽，再逐条精确过滤
+#define LOG_INDEX_SLACK_MS (5000)
+
+typedef struct log_index_head_t {
+    uint32_t magic;
+    uint32_t interval;
+    uint64_t ino; // 对应日志文件的inode，轮转（重命名）后不变，用于识别过期的索引
+} log_index_head_t;
+
+typedef struct log_index_entry_t {
+    int64_t timestamp;
+    uint64_t offset;
+} log_index_entry_t;
+
+static long index_interval() {
+    static long interval = -1;
+    if (interval < 0) {
+        interval = conf_size("SE_LOG_INDEX_INTERVAL", LOG_INDEX_DEFAULT_INTERVAL);
+        if (interval <= 0) {
+            interval = LOG_INDEX_DEFAULT_INTERVAL;
+        }
+    }
+    return interval;
+}
+
+// 打开当前日志文件log_path的索引文件，不存在或属于其他日志文件时重新创建
+static int index_open(const char *log_path, ino_t ino) {
+    char index_path[PATH_MAX];
+    if (snprintf(index_path, sizeof(index_path), "%s.idx", log_path) >= (int)sizeof(index_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+
+    int fd = open(index_path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        return -1;
+    }
+
+    log_index_head_t head;
+    if (pread(fd, &head, sizeof(head), 0) == sizeof(head) && head.magic == LOG_INDEX_MAGIC && head.ino == (uint64_t)ino) {
+        return fd;
+    }
+
+    head.magic    = LOG_INDEX_MAGIC;
+    head.interval = index_interval();
+    head.ino      = ino;
+    if (ftruncate(fd, 0) < 0 || write(fd, &head, sizeof(head)) != sizeof(head)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 写入端（持有日志锁）：在offset处写入了size字节，若跨过索引间隔则追加一项
+// record为本次写入的第一条记录，用于取得时间戳
+void log_index_append(int *idx_fd, const char *log_path, ino_t ino, off_t offset, size_t size, const char *record, size_t record_size) {
+    long interval = index_interval();
+    if (offset != 0 && offset / interval == (offset + (off_t)size) / interval) {
+        return;
+    }
+
+    log_record_t parsed;
+    if (log_record_parse(record, record_size, 1, &parsed) <= 0) {
+        return;
+    }
+
+    if (*idx_fd < 0) {
+        *idx_fd = index_open(log_path, ino);
+        if (*idx_fd < 0) {
+            return;
+        }
+    }
+
+    log_index_entry_t entry = {parsed.timestamp, offset};
+    write(*idx_fd, &entry, sizeof(entry));
+}
+
+// 读取索引，失败返回-1
+static int index_load(const char *index_path, ino_t ino, off_t file_size, log_index_entry_t **entries, size_t *count) {
+    int fd = open(index_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    log_index_head_t head;
+    if (fstat(fd, &st) < 0 || pread(fd, &head, sizeof(head), 0) != sizeof(head) ||
+        head.magic != LOG_INDEX_MAGIC || head.ino != (uint64_t)ino) {
+        close(fd);
+        return -1;
+    }
+
+    size_t n = (st.st_size - sizeof(head)) / sizeof(log_index_entry_t);
+    *entries = malloc((n + 1) * sizeof(log_index_entry_t));
+    if (!*entries) {
+        close(fd);
+        return -1;
+    }
+
+    ssize_t bytes = pread(fd, *entries, n * sizeof(log_index_entry_t), sizeof(head));
+    close(fd);
+    if (bytes < 0) {
+        free(*entries);
+        return -1;
+    }
+
+    // 丢弃不完整或超出日志文件大小的项
+    n = bytes / sizeof(log_index_entry_t);
+    while (n > 0 && (*entries)[n - 1].offset >= (uint64_t)file_size) {
+        n--;
+    }
+
+    *count = n;
+    return 0;
+}
+
+// 索引缺失时扫描日志文件重建；persist非0时（已轮转、不再写入的文件）保存到磁盘
+static int index_build(const char *path, const char *index_path, ino_t ino, int persist, log_index_entry_t **entries, size_t *count) {
+    log_scan_t scan;
+    log_record_t record;
+    size_t capacity = 64;
+    long interval   = index_interval();
+    long long next  = 0;
+
+    if (log_scan_open(&scan, path, 0) < 0) {
+        return -1;
+    }
+
+    *count   = 0;
+    *entries = malloc(capacity * sizeof(log_index_entry_t));
+    if (!*entries) {
+        log_scan_close(&scan);
+        return -1;
+    }
+
+    long long offset = log_scan_offset(&scan);
+    while (log_scan_next(&scan, &record)) {
+        if (offset >= next) {
+            if (*count == capacity) {
+                capacity *= 2;
+                log_index_entry_t *grown = realloc(*entries, capacity * sizeof(log_index_entry_t));
+                if (!grown) {
+                    break;
+                }
+                *entries = grown;
+            }
+            (*entries)[*count].timestamp = record.timestamp;
+            (*entries)[*count].offset    = offset;
+            (*count)++;
+            next = (offset / interval + 1) * interval;
+        }
+        offset = log_scan_offset(&scan);
+    }
+    log_scan_close(&scan);
+
+    char tmp_path[PATH_MAX];
+    if (persist && snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", index_path) < (int)sizeof(tmp_path)) {
+        int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        if (fd >= 0) {
+            log_index_head_t head = {LOG_INDEX_MAGIC, interval, ino};
+            size_t bytes          = *count * sizeof(log_index_entry_t);
+            int ok                = write(fd, &head, sizeof(head)) == sizeof(head) && write(fd, *entries, bytes) == (ssize_t)bytes;
+            close(fd);
+            if (!ok || rename(tmp_path, index_path) < 0) {
+                unlink(tmp_path);
+            }
+        }
+    }
+    return 0;
+}
+
+// 查询端：根据时间范围[start, end]（为0表示不限）计算需要扫描的字节范围[*start_offset, *end_offset)
+// *end_offset为-1表示读到文件末尾
+void log_index_range(const char *path, int persist, long start, long end, long long *start_offset, long long *end_offset) {
+    char index_path[PATH_MAX];
+    log_index_entry_t *entries = NULL;
+    size_t count               = 0;
+    struct stat st;
+
+    *start_offset = 0;
+    *end_offset   = -1;
+
+    if ((start <= 0 && end <= 0) || stat(path, &st) < 0) {
+        return;
+    }
+
+    // 路径过长时不使用索引，从头扫描
+    if (snprintf(index_path, sizeof(index_path), "%s.idx", path) >= (int)sizeof(index_path)) {
+        return;
+    }
+    if (index_load(index_path, st.st_ino, st.st_size, &entries, &count) < 0 &&
+        index_build(path, index_path, st.st_ino, persist, &entries, &count) < 0) {
+        return;
+    }
+
+    // 最后一个时间戳早于start的索引项之前的记录都不需要读
+    if (start > 0) {
+        size_t lo = 0, hi = count;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (entries[mid].timestamp < start - LOG_INDEX_SLACK_MS) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo > 0) {
+            *start_offset = entries[lo - 1].offset;
+        }
+    }
+
+    // 第一个时间戳晚于end的索引项之后的记录都不需要读
+    if (end > 0) {
+        size_t lo = 0, hi = count;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (entries[mid].timestamp <= end + LOG_INDEX_SLACK_MS) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo < count) {
+            *end_offset = entries[lo].offset;
+        }
+    }
+
+    free(entries);
+}
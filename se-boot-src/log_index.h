@@ -0,0 +1,17 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_LOG_INDEX_H
+#define SE_BOOT_LOG_INDEX_H
+
+#include <sys/types.h>
+
+void log_index_append(int *idx_fd, const char *log_path, ino_t ino, off_t offset, size_t size, const char *record, size_t record_size);
+void log_index_range(const char *path, int persist, long start, long end, long long *start_offset, long long *end_offset);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
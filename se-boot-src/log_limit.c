@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "se-boot-src/log_limit.h"
+#include "se-boot-src/conf.h"
+
+static long monotonic_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// 从环境变量读取限速配置：
+// SE_LOG_RATE_LINES（行/秒）、SE_LOG_RATE_BYTES（字节/秒，支持K/M/G后缀），未设置或为0时不限；
+// SE_LOG_BURST_LINES、SE_LOG_BURST_BYTES为允许的突发量，默认为1秒的量
+void log_limit_init(log_limit_t *limit) {
+    memset(limit, 0, sizeof(*limit));
+
+    long line_rate = conf_long("SE_LOG_RATE_LINES", 0);
+    long byte_rate = conf_size("SE_LOG_RATE_BYTES", 0);
+    limit->line_rate  = (line_rate > 0) ? line_rate : 0;
+    limit->byte_rate  = (byte_rate > 0) ? byte_rate : 0;
+
+    long line_burst = conf_long("SE_LOG_BURST_LINES", 0);
+    long byte_burst = conf_size("SE_LOG_BURST_BYTES", 0);
+    limit->line_burst = (line_burst > 0) ? line_burst : limit->line_rate;
+    limit->byte_burst = (byte_burst > 0) ? byte_burst : limit->byte_rate;
+
+    // 桶容量至少能放下一行，否则超过容量的行永远无法通过
+    if (limit->line_rate > 0 && limit->line_burst < 1) {
+        limit->line_burst = 1;
+    }
+
+    limit->line_tokens = limit->line_burst;
+    limit->byte_tokens = limit->byte_burst;
+    limit->last        = monotonic_ms();
+    limit->last_report = limit->last;
+}
+
+static void limit_refill(log_limit_t *limit) {
+    long now     = monotonic_ms();
+    double delta = (now - limit->last) / 1000.0;
+    limit->last  = now;
+
+    limit->line_tokens += delta * limit->line_rate;
+    if (limit->line_tokens > limit->line_burst) {
+        limit->line_tokens = limit->line_burst;
+    }
+    limit->byte_tokens += delta * limit->byte_rate;
+    if (limit->byte_tokens > limit->byte_burst) {
+        limit->byte_tokens = limit->byte_burst;
+    }
+}
+
+// 判断一行能否通过，能则扣除令牌；超过桶容量的行按容量计
+static int limit_take(log_limit_t *limit, size_t len) {
+    double bytes = (len < limit->byte_burst) ? len : limit->byte_burst;
+
+    if ((limit->line_rate > 0 && limit->line_tokens < 1) || (limit->byte_rate > 0 && limit->byte_tokens < bytes)) {
+        return 0;
+    }
+    if (limit->line_rate > 0) {
+        limit->line_tokens -= 1;
+    }
+    if (limit->byte_rate > 0) {
+        limit->byte_tokens -= bytes;
+    }
+    return 1;
+}
+
+// 按行（与log_writer_write的切分方式一致）过滤一次read得到的数据，超出限速的行被丢弃并计数，
+// 保留的行原地前移，返回保留部分的大小；丢弃的行不会进入日志锁和文件系统
+size_t log_limit_filter(log_limit_t *limit, char *buffer, size_t size) {
+    if (limit->line_rate <= 0 && limit->byte_rate <= 0) {
+        return size;
+    }
+
+    limit_refill(limit);
+
+    char *line = buffer;
+    char *end  = buffer + size;
+    char *keep = buffer;
+
+    while (line < end) {
+        char *next = memchr(line, '\n', end - line);
+        next       = next ? next + 1 : end;
+        size_t len = next - line;
+
+        // 空行不产生记录，不计入限速
+        if (len == 1 && *line == '\n') {
+            line = next;
+            continue;
+        }
+
+        if (limit_take(limit, len)) {
+            if (keep != line) {
+                memmove(keep, line, len);
+            }
+            keep += len;
+        } else {
+            // 从第一次丢弃开始计时，之后每隔LOG_LIMIT_REPORT_INTERVAL汇总一次
+            if (limit->suppressed_lines == 0) {
+                limit->last_report = limit->last;
+            }
+            limit->suppressed_lines++;
+            limit->suppressed_bytes += len;
+        }
+        line = next;
+    }
+
+    return keep - buffer;
+}
+
+// 距下一次汇总的毫秒数，没有被丢弃的行时返回-1（无需定时）
+int log_limit_timeout(const log_limit_t *limit) {
+    if (limit->suppressed_lines == 0) {
+        return -1;
+    }
+
+    long remaining = limit->last_report + LOG_LIMIT_REPORT_INTERVAL - monotonic_ms();
+    return (remaining > 0) ? (int)remaining : 0;
+}
+
+// 自上次汇总起有被丢弃的行且已到汇总时间（或force）时，生成"N lines suppressed"消息并返回1
+int log_limit_report(log_limit_t *limit, int force, char *msg, size_t msg_size) {
+    if (limit->suppressed_lines == 0 || (!force && log_limit_timeout(limit) > 0)) {
+        return 0;
+    }
+
+    snprintf(msg, msg_size, "%lu lines suppressed (%lu bytes) by rate limit", limit->suppressed_lines, limit->suppressed_bytes);
+    limit->suppressed_lines = 0;
+    limit->suppressed_bytes = 0;
+    limit->last_report      = monotonic_ms();
+    return 1;
+}
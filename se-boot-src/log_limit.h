@@ -0,0 +1,36 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_LOG_LIMIT_H
+#define SE_BOOT_LOG_LIMIT_H
+
+#include <stddef.h>
+
+#define LOG_LIMIT_REPORT_INTERVAL (5000) // 汇总被丢弃行数的间隔（毫秒）
+
+// 单个进程输出的令牌桶限速，行数与字节数各一个桶，速率为0表示不限
+typedef struct log_limit_t {
+    double line_rate; // 每秒补充的令牌
+    double byte_rate;
+    double line_burst; // 桶容量
+    double byte_burst;
+    double line_tokens;
+    double byte_tokens;
+    long last; // 上次补充令牌的时间（毫秒，单调时钟）
+
+    unsigned long suppressed_lines; // 自上次汇总以来丢弃的行数与字节数
+    unsigned long suppressed_bytes;
+    long last_report;
+} log_limit_t;
+
+void log_limit_init(log_limit_t *limit);
+size_t log_limit_filter(log_limit_t *limit, char *buffer, size_t size);
+int log_limit_timeout(const log_limit_t *limit);
+int log_limit_report(log_limit_t *limit, int force, char *msg, size_t msg_size);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
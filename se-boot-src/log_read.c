@@ -0,0 +1,1475 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <getopt.h>
+#include <sys/inotify.h>
+#include <pthread.h>
+#include <dirent.h>
+#include "se-boot-src/log.h"
+#include "se-boot-src/log_record.h"
+#include "se-boot-src/log_filter.h"
+#include "se-boot-src/log_store.h"
+#include "se-boot-src/log_stats.h"
+#include "se-boot-src/path.h"
+
+#define LOG_OUTPUT_BUFFER_SIZE (256 * 1024) // 输出缓冲区，内存占用与结果大小无关
+#define LOG_OUTPUT_FIRST_FLUSH (4 * 1024)    // 第一次写出的阈值，之后逐次翻倍，使前几行尽快输出
+#define LOG_LINE_MAX_SIZE (LOG_RECORD_MAX_SIZE + 64) // 格式化后单行的最大长度
+#define LOG_JOBS_MAX (64)
+#define LOG_JOB_CHUNK_MIN (4 * 1024 * 1024) // 并行查询时每块的最小字节数
+#define LOG_JOB_WINDOW (4)                  // 每个线程最多领先输出的块数，限制缓存的结果大小
+
+extern const char *log_type_map[];
+
+const char *log_type_map[] = {"process", "boot", "stderr"};
+
+// 流式输出：格式化结果直接写入输出缓冲区，攒够后一次write
+typedef struct log_output_t {
+    int fd;
+    int error;
+    char *buffer;
+    size_t len;
+    size_t limit;
+    log_stats_t *stats; // --stats：匹配的记录只计入统计，不格式化
+} log_output_t;
+
+// 将毫秒时间戳转换为可读时间格式
+static void timestamp_to_human(long timestamp, char *buffer, size_t buffer_size) {
+    time_t seconds    = timestamp / 1000;
+    long milliseconds = timestamp % 1000;
+    struct tm tm_info;
+
+    // 并行查询时多个线程同时格式化，使用可重入版本
+    localtime_r(&seconds, &tm_info);
+    strftime(buffer, buffer_size, "%Y-%m-%d %H:%M:%S", &tm_info);
+    snprintf(buffer + strlen(buffer), buffer_size - strlen(buffer), ":%06ld", milliseconds * 1000);
+}
+
+// 写入"[字段]"，返回写入的长度
+static int put_field(char *dest, const char *field, unsigned int len) {
+    dest[0] = '[';
+    memcpy(dest + 1, field, len);
+    dest[len + 1] = ']';
+    return len + 2;
+}
+
+// 写入"[数字]"，返回写入的长度
+static int put_number(char *dest, long value) {
+    char digits[24];
+    int count              = 0;
+    unsigned long absolute = value < 0 ? -(unsigned long)value : (unsigned long)value;
+
+    do {
+        digits[sizeof(digits) - 1 - count++] = '0' + absolute % 10;
+        absolute /= 10;
+    } while (absolute);
+
+    if (value < 0) {
+        digits[sizeof(digits) - 1 - count++] = '-';
+    }
+    return put_field(dest, digits + sizeof(digits) - count, count);
+}
+
+// 格式化日志行：直接从记录的字段视图拼接，返回长度（不含结尾的'\0'）
+static int format_log_line(char *dest, const log_record_t *record, log_filter_t *filter) {
+    char human_time[32];
+    int len = 0;
+
+    if (!(filter->flag & LOG_FILTER_FLAG_exclude_timestamp)) {
+        if (filter->flag & LOG_FILTER_FLAG_human_time) {
+            timestamp_to_human(record->timestamp, human_time, sizeof(human_time));
+            len += put_field(dest + len, human_time, strlen(human_time));
+        } else {
+            len += put_number(dest + len, record->timestamp);
+        }
+    }
+
+    if (!(filter->flag & LOG_FILTER_FLAG_exclude_type)) {
+        if ((filter->flag & LOG_FILTER_FLAG_human_type) && record->type >= 0 && record->type <= LOG_TYPE_STDERR) {
+            len += put_field(dest + len, log_type_map[record->type], strlen(log_type_map[record->type]));
+        } else {
+            len += put_number(dest + len, record->type);
+        }
+    }
+
+    if (!(filter->flag & LOG_FILTER_FLAG_exclude_pid)) {
+        len += put_number(dest + len, record->pid);
+    }
+
+    if (!(filter->flag & LOG_FILTER_FLAG_exclude_path)) {
+        len += put_field(dest + len, record->path, record->path_len);
+    }
+
+    if (!(filter->flag & LOG_FILTER_FLAG_exclude_name)) {
+        len += put_field(dest + len, record->name, record->name_len);
+    }
+
+    dest[len++] = ':';
+    memcpy(dest + len, record->msg, record->msg_len);
+    len += record->msg_len;
+    dest[len++] = '\n';
+    dest[len]   = '\0';
+    return len;
+}
+
+static void output_write_all(log_output_t *out, const char *data, size_t size) {
+    size_t written = 0;
+    while (written < size && !out->error) {
+        ssize_t n = write(out->fd, data + written, size - written);
+        if (n < 0 && errno != EINTR) {
+            out->error = 1;
+        } else if (n > 0) {
+            written += n;
+        }
+    }
+}
+
+static void output_flush(log_output_t *out) {
+    output_write_all(out, out->buffer, out->len);
+    out->len = 0;
+
+    if (out->limit < LOG_OUTPUT_BUFFER_SIZE) {
+        out->limit *= 2;
+    }
+}
+
+// 输出一段已格式化的数据，不经过输出缓冲区
+static void output_write(log_output_t *out, const char *data, size_t size) {
+    output_flush(out);
+    output_write_all(out, data, size);
+}
+
+// 格式化一条记录到输出缓冲区
+static void output_record(log_output_t *out, const log_record_t *record, log_filter_t *filter) {
+    if (out->stats) {
+        log_stats_add(out->stats, record);
+        return;
+    }
+
+    if (out->len + LOG_LINE_MAX_SIZE > LOG_OUTPUT_BUFFER_SIZE) {
+        output_flush(out);
+    }
+
+    out->len += format_log_line(out->buffer + out->len, record, filter);
+    if (out->len >= out->limit) {
+        output_flush(out);
+    }
+}
+
+// 格式化输出一行到输出缓冲区（用于统计结果等非记录内容）
+static void output_printf(log_output_t *out, const char *format, ...) {
+    if (out->len + LOG_LINE_MAX_SIZE > LOG_OUTPUT_BUFFER_SIZE) {
+        output_flush(out);
+    }
+
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(out->buffer + out->len, LOG_OUTPUT_BUFFER_SIZE - out->len, format, args);
+    va_end(args);
+
+    if (len > 0) {
+        out->len += ((size_t)len < LOG_OUTPUT_BUFFER_SIZE - out->len) ? (size_t)len : LOG_OUTPUT_BUFFER_SIZE - out->len - 1;
+    }
+}
+
+// 统计结果中的时间，-H时为可读格式
+static const char *stats_time(long timestamp, log_filter_t *filter, char *buffer, size_t size) {
+    if (filter->flag & LOG_FILTER_FLAG_human_time) {
+        timestamp_to_human(timestamp, buffer, size);
+    } else {
+        snprintf(buffer, size, "%ld", timestamp);
+    }
+    return buffer;
+}
+
+// 输出一个分组的统计，每行为"条数 字节数 最早 最晚 键"，以制表符分隔，按条数从多到少排列
+static void stats_print_table(log_output_t *out, log_filter_t *filter, const char *title, const log_stats_table_t *table) {
+    char first[32];
+    char last[32];
+
+    log_stats_entry_t **sorted = log_stats_sorted(table, 0);
+    if (!sorted) {
+        out->error = 1;
+        return;
+    }
+
+    output_printf(out, "\n[%s]\ncount\tbytes\tfirst\tlast\t%s\n", title, title);
+    for (log_stats_entry_t **p = sorted; *p; p++) {
+        log_stats_entry_t *entry = *p;
+        output_printf(out, "%lu\t%llu\t%s\t%s\t", entry->count, entry->bytes, stats_time(entry->first, filter, first, sizeof(first)),
+                      stats_time(entry->last, filter, last, sizeof(last)));
+        if (entry->name) {
+            output_printf(out, "%s\n", entry->name);
+        } else {
+            output_printf(out, "%ld\n", entry->key);
+        }
+    }
+    free(sorted);
+}
+
+// 输出--stats的结果：总计、按名称/pid/类型分组，以及指定了--bucket时的时间直方图
+static void stats_print(log_output_t *out, log_filter_t *filter, log_stats_t *stats, const char *bucket) {
+    char first[32];
+    char last[32];
+
+    output_printf(out, "[total]\ncount\tbytes\tfirst\tlast\n");
+    if (stats->total.count > 0) {
+        output_printf(out, "%lu\t%llu\t%s\t%s\n", stats->total.count, stats->total.bytes,
+                      stats_time(stats->total.first, filter, first, sizeof(first)), stats_time(stats->total.last, filter, last, sizeof(last)));
+    } else {
+        output_printf(out, "0\t0\t-\t-\n");
+    }
+
+    stats_print_table(out, filter, "name", &stats->names);
+    stats_print_table(out, filter, "pid", &stats->pids);
+    stats_print_table(out, filter, "type", &stats->types);
+
+    if (stats->bucket <= 0) {
+        return;
+    }
+
+    // 直方图按时间顺序输出，没有记录的桶不输出
+    log_stats_entry_t **sorted = log_stats_sorted(&stats->buckets, 1);
+    if (!sorted) {
+        out->error = 1;
+        return;
+    }
+    output_printf(out, "\n[bucket %s]\nstart\tcount\tbytes\n", bucket);
+    for (log_stats_entry_t **p = sorted; *p; p++) {
+        output_printf(out, "%s\t%lu\t%llu\n", stats_time((*p)->key, filter, first, sizeof(first)), (*p)->count, (*p)->bytes);
+    }
+    free(sorted);
+}
+
+// 解析时间桶宽度，如"1s"、"1m"、"1h"，返回毫秒数，格式错误返回-1
+static long parse_bucket(const char *str) {
+    char *end;
+    long value = strtol(str, &end, 10);
+    if (end == str) {
+        value = 1; // 只写单位时为1个单位
+    }
+    if (value <= 0) {
+        return -1;
+    }
+
+    if (strcmp(end, "ms") == 0) {
+        return value;
+    } else if (strcmp(end, "s") == 0 || *end == '\0') {
+        return value * 1000;
+    } else if (strcmp(end, "m") == 0) {
+        return value * 60 * 1000;
+    } else if (strcmp(end, "h") == 0) {
+        return value * 60 * 60 * 1000;
+    } else if (strcmp(end, "d") == 0) {
+        return value * 24 * 60 * 60 * 1000;
+    }
+    return -1;
+}
+
+// 一个日志流：SE_LOG或某个服务的分片，各自独立轮转，流内的记录按时间顺序排列
+typedef struct log_stream_t {
+    char base[256];  // 当前日志文件路径，历史日志为base.N
+    int last;        // 最旧一代的编号
+    log_gen_t *gens; // 第0..last代
+    ino_t end_ino;   // 当前日志文件已读取到的位置，--follow从这里继续
+    long long end_offset;
+} log_stream_t;
+
+// 查询涉及的所有日志流，第一个为SE_LOG，其后为按路径排序的分片
+typedef struct log_streams_t {
+    log_stream_t *items;
+    int count;
+    int cap;
+} log_streams_t;
+
+static int streams_add(log_streams_t *streams, const char *base) {
+    // 多个服务名可能对应同一个分片
+    for (int i = 0; i < streams->count; i++) {
+        if (strcmp(streams->items[i].base, base) == 0) {
+            return 0;
+        }
+    }
+
+    if (streams->count == streams->cap) {
+        int cap               = streams->cap ? streams->cap * 2 : 16;
+        log_stream_t *grown = realloc(streams->items, cap * sizeof(log_stream_t));
+        if (!grown) {
+            return -1;
+        }
+        streams->items = grown;
+        streams->cap   = cap;
+    }
+
+    log_stream_t *stream = &streams->items[streams->count++];
+    memset(stream, 0, sizeof(*stream));
+    snprintf(stream->base, sizeof(stream->base), "%s", base);
+    return 0;
+}
+
+static int compare_stream(const void *a, const void *b) {
+    return strcmp(((const log_stream_t *)a)->base, ((const log_stream_t *)b)->base);
+}
+
+// 分片目录中的文件名是否为某个服务的当前日志文件（"<服务名>.log"）
+static int shard_file(const char *file) {
+    size_t len = strlen(file);
+    return len > 4 && strcmp(file + len - 4, ".log") == 0;
+}
+
+// 分片是否属于查询的服务：指定了--name时只读取这些服务的分片
+static int shard_wanted(log_filter_t *filter, const char *base) {
+    char path[256];
+
+    if (filter->filter_name_size == 0) {
+        return 1;
+    }
+    for (unsigned int i = 0; i < filter->filter_name_size; i++) {
+        log_shard_path(filter->filter_name[i], path, sizeof(path));
+        if (strcmp(path, base) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 查找需要读取的日志流：SE_LOG（未开启分片时写入的日志）以及各服务的分片
+static int streams_find(log_streams_t *streams, log_filter_t *filter) {
+    char base[256];
+
+    if (streams_add(streams, SE_LOG) < 0) {
+        return -1;
+    }
+
+    if (filter->filter_name_size > 0) {
+        for (unsigned int i = 0; i < filter->filter_name_size; i++) {
+            log_shard_path(filter->filter_name[i], base, sizeof(base));
+            if (streams_add(streams, base) < 0) {
+                return -1;
+            }
+        }
+    } else {
+        DIR *dir = opendir(SE_LOG_SHARD_DIR);
+        struct dirent *entry;
+
+        while (dir && (entry = readdir(dir))) {
+            if (!shard_file(entry->d_name)) {
+                continue;
+            }
+            // 超出路径长度的文件不可能是se-boot写入的分片
+            if (snprintf(base, sizeof(base), "%s/%s", SE_LOG_SHARD_DIR, entry->d_name) >= (int)sizeof(base)) {
+                continue;
+            }
+            if (streams_add(streams, base) < 0) {
+                closedir(dir);
+                return -1;
+            }
+        }
+        if (dir) {
+            closedir(dir);
+        }
+    }
+
+    // 时间戳相同的记录按分片路径的顺序输出，使结果稳定
+    qsort(streams->items + 1, streams->count - 1, sizeof(log_stream_t), compare_stream);
+    return 0;
+}
+
+// 打开流的各代日志，返回打开的代数
+static int stream_open(log_stream_t *stream, log_filter_t *filter) {
+    int opened = 0;
+
+    stream->last = log_gen_last(stream->base);
+    stream->gens = calloc(stream->last + 1, sizeof(log_gen_t));
+    if (!stream->gens) {
+        stream->last = -1;
+        return 0;
+    }
+
+    for (int gen = 0; gen <= stream->last; gen++) {
+        if (log_gen_open(&stream->gens[gen], stream->base, gen, filter->filter_time_start, filter->filter_time_end) == 0) {
+            opened++;
+        }
+    }
+
+    // 记录当前日志文件本次读取到的位置
+    log_gen_t *current = &stream->gens[0];
+    struct stat st;
+    if (current->segment_count > 0 && !current->archived && fstat(current->fd, &st) == 0) {
+        stream->end_ino    = st.st_ino;
+        stream->end_offset = current->size;
+    }
+    return opened;
+}
+
+static void stream_close(log_stream_t *stream) {
+    for (int gen = 0; gen <= stream->last; gen++) {
+        log_gen_close(&stream->gens[gen]);
+    }
+    free(stream->gens);
+    stream->gens = NULL;
+    stream->last = -1;
+}
+
+// 流中的读取位置，可在各代、各段之间向前或向后移动
+typedef struct log_cursor_t {
+    log_stream_t *stream;
+    int index;   // 流的序号，时间戳相同时用于确定顺序
+    int gen;
+    int segment;
+    char *buffer; // 解压压缩块的缓冲区，按需分配
+    log_rscan_t scan;
+    log_record_t record; // 当前记录
+
+    int mark_gen; // 最早一条已计入的匹配记录的位置，取最新N条时第二遍从这里开始
+    int mark_segment;
+    size_t mark_pos;
+} log_cursor_t;
+
+// 载入第gen代的第segment段，不存在或读取失败时为空段
+static void cursor_load(log_cursor_t *cursor, int gen, int segment) {
+    log_gen_t *g = &cursor->stream->gens[gen];
+    log_segment_t data;
+
+    cursor->gen     = gen;
+    cursor->segment = segment;
+    log_rscan_init(&cursor->scan, NULL, 0, 0);
+
+    if (segment < 0 || segment >= g->segment_count) {
+        return;
+    }
+    if (g->archived && !cursor->buffer) {
+        cursor->buffer = malloc(LOG_ARCHIVE_BLOCK_MAX);
+        if (!cursor->buffer) {
+            return;
+        }
+    }
+    if (log_gen_segment(g, segment, cursor->buffer, &data) == 0) {
+        log_rscan_init(&cursor->scan, data.data, data.start, data.end);
+    }
+}
+
+// 定位到流的开头（dir > 0）或末尾（dir < 0）之外，之后分别用cursor_next、cursor_prev读取
+static void cursor_init(log_cursor_t *cursor, log_stream_t *stream, int index, int dir) {
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->stream = stream;
+    cursor->index  = index;
+
+    if (dir > 0) {
+        cursor->gen     = stream->last;
+        cursor->segment = -1;
+    } else {
+        cursor->gen     = 0;
+        cursor->segment = (stream->last >= 0) ? stream->gens[0].segment_count : 0;
+    }
+    log_rscan_init(&cursor->scan, NULL, 0, 0);
+
+    cursor->mark_gen     = cursor->gen;
+    cursor->mark_segment = cursor->segment;
+}
+
+// 读取下一条（较新的）记录，成功返回1
+static int cursor_next(log_cursor_t *cursor) {
+    log_stream_t *stream = cursor->stream;
+
+    while (!log_rscan_next(&cursor->scan, &cursor->record)) {
+        int gen     = cursor->gen;
+        int segment = cursor->segment + 1;
+        while (gen >= 0 && segment >= stream->gens[gen].segment_count) {
+            gen--;
+            segment = 0;
+        }
+        if (gen < 0) {
+            return 0;
+        }
+        cursor_load(cursor, gen, segment);
+        cursor->scan.pos = cursor->scan.start;
+    }
+    return 1;
+}
+
+// 读取前一条（较早的）记录，成功返回1
+static int cursor_prev(log_cursor_t *cursor) {
+    log_stream_t *stream = cursor->stream;
+
+    while (!log_rscan_prev(&cursor->scan, &cursor->record)) {
+        int gen     = cursor->gen;
+        int segment = cursor->segment - 1;
+        while (gen <= stream->last && segment < 0) {
+            if (++gen <= stream->last) {
+                segment = stream->gens[gen].segment_count - 1;
+            }
+        }
+        if (gen > stream->last) {
+            return 0;
+        }
+        cursor_load(cursor, gen, segment);
+    }
+    return 1;
+}
+
+// 记下cursor_prev刚读到的记录的位置
+static void cursor_mark(log_cursor_t *cursor) {
+    cursor->mark_gen     = cursor->gen;
+    cursor->mark_segment = cursor->segment;
+    cursor->mark_pos     = cursor->scan.pos;
+}
+
+// 回到记下的位置，之后用cursor_next从该记录开始向后读取
+static void cursor_seek_mark(log_cursor_t *cursor) {
+    if (cursor->stream->last < 0) {
+        return;
+    }
+    cursor_load(cursor, cursor->mark_gen, cursor->mark_segment);
+    if (cursor->mark_pos >= cursor->scan.start && cursor->mark_pos <= cursor->scan.end) {
+        cursor->scan.pos = cursor->mark_pos;
+    }
+}
+
+// 按时间戳合并多个流：堆顶为下一条要输出的记录，reverse为1时从新到旧
+typedef struct log_merge_t {
+    log_cursor_t **heap;
+    int size;
+    int reverse;
+} log_merge_t;
+
+static int merge_before(const log_merge_t *merge, const log_cursor_t *a, const log_cursor_t *b) {
+    if (a->record.timestamp != b->record.timestamp) {
+        return merge->reverse ? a->record.timestamp > b->record.timestamp : a->record.timestamp < b->record.timestamp;
+    }
+    return merge->reverse ? a->index > b->index : a->index < b->index;
+}
+
+static void merge_sift_down(log_merge_t *merge, int i) {
+    for (;;) {
+        int best  = i;
+        int left  = 2 * i + 1;
+        int right = left + 1;
+        if (left < merge->size && merge_before(merge, merge->heap[left], merge->heap[best])) {
+            best = left;
+        }
+        if (right < merge->size && merge_before(merge, merge->heap[right], merge->heap[best])) {
+            best = right;
+        }
+        if (best == i) {
+            return;
+        }
+        log_cursor_t *tmp = merge->heap[i];
+        merge->heap[i]    = merge->heap[best];
+        merge->heap[best] = tmp;
+        i                 = best;
+    }
+}
+
+// 读取游标的第一条记录并加入合并
+static void merge_push(log_merge_t *merge, log_cursor_t *cursor) {
+    if (!(merge->reverse ? cursor_prev(cursor) : cursor_next(cursor))) {
+        return;
+    }
+
+    int i               = merge->size++;
+    merge->heap[i]      = cursor;
+    while (i > 0 && merge_before(merge, merge->heap[i], merge->heap[(i - 1) / 2])) {
+        log_cursor_t *tmp           = merge->heap[i];
+        merge->heap[i]              = merge->heap[(i - 1) / 2];
+        merge->heap[(i - 1) / 2]    = tmp;
+        i                           = (i - 1) / 2;
+    }
+}
+
+// 堆顶的记录已处理，读取该流的下一条
+static void merge_advance(log_merge_t *merge) {
+    log_cursor_t *top = merge->heap[0];
+    if (!(merge->reverse ? cursor_prev(top) : cursor_next(top))) {
+        merge->heap[0] = merge->heap[--merge->size];
+    }
+    merge_sift_down(merge, 0);
+}
+
+// 取最新的filter_num条匹配记录：先从各流末尾向前按时间合并读取，凑够数量即停止，
+// 各流记下最早一条计入的记录的位置，再从这些位置向后合并读取并输出，内存占用与数量无关；
+// 耗时只与需要读取的记录数有关，与日志总大小无关
+// 两遍读取使用同一组映射，期间发生轮转也不影响结果；压缩的历史日志逐块解压，第二遍重新解压
+static int log_read_tail(log_output_t *out, log_filter_t *filter, log_streams_t *streams) {
+    int count   = 0;
+    int emitted = 0;
+    log_cursor_t *cursors = calloc(streams->count, sizeof(log_cursor_t));
+    log_cursor_t **heap   = calloc(streams->count, sizeof(log_cursor_t *));
+    log_merge_t merge     = {.heap = heap, .reverse = 1};
+
+    if (!cursors || !heap) {
+        free(cursors);
+        free(heap);
+        return -1;
+    }
+
+    for (int i = 0; i < streams->count; i++) {
+        cursor_init(&cursors[i], &streams->items[i], i, -1);
+        merge_push(&merge, &cursors[i]);
+    }
+
+    while (merge.size > 0 && count < filter->filter_num) {
+        log_cursor_t *cursor = merge.heap[0];
+        if (log_filter_match(filter, &cursor->record)) {
+            cursor_mark(cursor);
+            count++;
+        }
+        merge_advance(&merge);
+    }
+
+    // 从找到的最早一条开始按时间顺序输出；各流中记下的位置之后的记录都已在第一遍读过
+    merge.size    = 0;
+    merge.reverse = 0;
+    for (int i = 0; i < streams->count; i++) {
+        cursor_seek_mark(&cursors[i]);
+        merge_push(&merge, &cursors[i]);
+    }
+
+    while (merge.size > 0 && emitted < count) {
+        log_cursor_t *cursor = merge.heap[0];
+        if (log_filter_match(filter, &cursor->record)) {
+            output_record(out, &cursor->record, filter);
+            emitted++;
+        }
+        merge_advance(&merge);
+    }
+
+    for (int i = 0; i < streams->count; i++) {
+        free(cursors[i].buffer);
+    }
+    free(cursors);
+    free(heap);
+    return emitted;
+}
+
+// 按时间顺序读取全部匹配记录；只有一个流时即为从最旧的一代依次读到当前日志文件
+static int log_read_merge(log_output_t *out, log_filter_t *filter, log_streams_t *streams) {
+    int count = 0;
+    log_cursor_t *cursors = calloc(streams->count, sizeof(log_cursor_t));
+    log_cursor_t **heap   = calloc(streams->count, sizeof(log_cursor_t *));
+    log_merge_t merge     = {.heap = heap, .reverse = 0};
+
+    if (!cursors || !heap) {
+        free(cursors);
+        free(heap);
+        return -1;
+    }
+
+    for (int i = 0; i < streams->count; i++) {
+        cursor_init(&cursors[i], &streams->items[i], i, 1);
+        merge_push(&merge, &cursors[i]);
+    }
+
+    while (merge.size > 0) {
+        log_cursor_t *cursor = merge.heap[0];
+        if (log_filter_match(filter, &cursor->record)) {
+            output_record(out, &cursor->record, filter);
+            count++;
+        }
+        merge_advance(&merge);
+    }
+
+    for (int i = 0; i < streams->count; i++) {
+        free(cursors[i].buffer);
+    }
+    free(cursors);
+    free(heap);
+    return count;
+}
+
+// 并行查询中的一块：某一代日志文件中以记录边界对齐的一段，或压缩日志中的一个块
+typedef struct log_chunk_t {
+    const char *data;
+    size_t start;
+    size_t end;
+    const log_gen_t *gen; // 压缩日志的块由工作线程解压，此时data为空
+    int segment;
+
+    char *out; // 该块格式化后的结果
+    size_t out_len;
+    size_t out_cap;
+    int count;
+    int error;
+    int done;
+} log_chunk_t;
+
+typedef struct log_jobs_t {
+    log_filter_t *filter;
+    log_chunk_t *chunks;
+    int chunk_count;
+    int next;    // 下一个待处理的块
+    int written; // 已输出的块数
+    int window;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} log_jobs_t;
+
+static void chunk_append(log_chunk_t *chunk, const log_record_t *record, log_filter_t *filter) {
+    if (chunk->out_len + LOG_LINE_MAX_SIZE > chunk->out_cap) {
+        size_t cap = chunk->out_cap ? chunk->out_cap * 2 : 64 * 1024;
+        char *out  = realloc(chunk->out, cap);
+        if (!out) {
+            chunk->error = 1;
+            return;
+        }
+        chunk->out     = out;
+        chunk->out_cap = cap;
+    }
+    chunk->out_len += format_log_line(chunk->out + chunk->out_len, record, filter);
+    chunk->count++;
+}
+
+// 过滤、格式化一块，压缩日志的块先解压到buffer
+static void chunk_process(log_chunk_t *chunk, log_filter_t *filter, char **buffer) {
+    log_segment_t segment = {chunk->data, chunk->start, chunk->end};
+    log_record_t record;
+
+    if (chunk->gen) {
+        if (!*buffer) {
+            *buffer = malloc(LOG_ARCHIVE_BLOCK_MAX);
+        }
+        if (!*buffer || log_gen_segment(chunk->gen, chunk->segment, *buffer, &segment) < 0) {
+            chunk->error = 1;
+            return;
+        }
+    }
+
+    size_t pos = segment.start;
+    while (pos < segment.end) {
+        int ret = log_record_parse(segment.data + pos, segment.end - pos, 1, &record);
+        if (ret == 0) {
+            break;
+        }
+        if (ret < 0) {
+            pos += -ret;
+            continue;
+        }
+        pos += ret;
+        if (log_filter_match(filter, &record)) {
+            chunk_append(chunk, &record, filter);
+        }
+    }
+}
+
+static void *jobs_worker(void *arg) {
+    log_jobs_t *jobs = arg;
+    char *buffer     = NULL;
+
+    pthread_mutex_lock(&jobs->lock);
+    while (jobs->next < jobs->chunk_count) {
+        // 领先输出太多时等待，避免结果全部堆积在内存中
+        if (jobs->next >= jobs->written + jobs->window) {
+            pthread_cond_wait(&jobs->cond, &jobs->lock);
+            continue;
+        }
+        log_chunk_t *chunk = &jobs->chunks[jobs->next++];
+        pthread_mutex_unlock(&jobs->lock);
+
+        chunk_process(chunk, jobs->filter, &buffer);
+
+        pthread_mutex_lock(&jobs->lock);
+        chunk->done = 1;
+        pthread_cond_broadcast(&jobs->cond);
+    }
+    pthread_mutex_unlock(&jobs->lock);
+    free(buffer);
+    return NULL;
+}
+
+static log_chunk_t *jobs_add(log_chunk_t **chunks, int *count, int *cap) {
+    if (*count == *cap) {
+        int grown_cap      = *cap ? *cap * 2 : 64;
+        log_chunk_t *grown = realloc(*chunks, grown_cap * sizeof(log_chunk_t));
+        if (!grown) {
+            return NULL;
+        }
+        *chunks = grown;
+        *cap    = grown_cap;
+    }
+
+    log_chunk_t *chunk = &(*chunks)[(*count)++];
+    memset(chunk, 0, sizeof(*chunk));
+    return chunk;
+}
+
+// 将一代日志切分为块：普通文件的[start, end)按记录边界切分，压缩日志每个块为一块
+static int jobs_split(log_chunk_t **chunks, int *count, int *cap, const log_gen_t *gen, size_t chunk_size) {
+    if (gen->archived) {
+        for (int i = 0; i < gen->segment_count; i++) {
+            log_chunk_t *chunk = jobs_add(chunks, count, cap);
+            if (!chunk) {
+                return -1;
+            }
+            chunk->gen     = gen;
+            chunk->segment = i;
+        }
+        return 0;
+    }
+
+    size_t start = gen->start;
+    while (start < gen->end) {
+        size_t next = gen->end;
+        if (gen->end - start > chunk_size) {
+            next = log_record_sync(gen->map, gen->end, start + chunk_size);
+        }
+
+        log_chunk_t *chunk = jobs_add(chunks, count, cap);
+        if (!chunk) {
+            return -1;
+        }
+        chunk->data  = gen->map;
+        chunk->start = start;
+        chunk->end   = next;
+        start        = next;
+    }
+    return 0;
+}
+
+// --jobs：将各代日志文件切分为以记录边界对齐的块，由多个线程并行过滤、格式化，
+// 再按文件顺序依次输出，结果与单线程读取完全相同；只用于单个流（多个流需要按时间合并）
+static int log_read_jobs(log_output_t *out, log_filter_t *filter, log_stream_t *stream, int thread_count) {
+    int ok       = 1;
+    int count    = 0;
+    int cap      = 0;
+    size_t total = 0;
+    log_jobs_t jobs = {.filter = filter, .window = thread_count * LOG_JOB_WINDOW};
+    pthread_t threads[LOG_JOBS_MAX];
+    log_gen_t *gens = stream->gens;
+
+    for (int gen = stream->last; gen >= 0; gen--) {
+        if (gens[gen].archived) {
+            for (int i = 0; i < gens[gen].segment_count; i++) {
+                total += gens[gen].archive.blocks[gens[gen].segments[i]].raw_size;
+            }
+        } else if (gens[gen].segment_count > 0) {
+            total += gens[gen].end - gens[gen].start;
+        }
+    }
+
+    size_t chunk_size = total / (thread_count * LOG_JOB_WINDOW);
+    if (chunk_size < LOG_JOB_CHUNK_MIN) {
+        chunk_size = LOG_JOB_CHUNK_MIN;
+    }
+
+    // 从最旧的一代到当前日志文件依次切分
+    for (int gen = stream->last; gen >= 0; gen--) {
+        if (gens[gen].segment_count > 0 && jobs_split(&jobs.chunks, &jobs.chunk_count, &cap, &gens[gen], chunk_size) < 0) {
+            ok = 0;
+            goto cleanup;
+        }
+    }
+
+    pthread_mutex_init(&jobs.lock, NULL);
+    pthread_cond_init(&jobs.cond, NULL);
+
+    if (thread_count > jobs.chunk_count) {
+        thread_count = jobs.chunk_count;
+    }
+    int started = 0;
+    for (; started < thread_count; started++) {
+        if (pthread_create(&threads[started], NULL, jobs_worker, &jobs) != 0) {
+            break;
+        }
+    }
+
+    // 按顺序输出各块的结果；没有线程启动成功时由当前线程处理
+    for (int i = 0; i < jobs.chunk_count; i++) {
+        log_chunk_t *chunk = &jobs.chunks[i];
+
+        pthread_mutex_lock(&jobs.lock);
+        while (!chunk->done && started > 0) {
+            pthread_cond_wait(&jobs.cond, &jobs.lock);
+        }
+        pthread_mutex_unlock(&jobs.lock);
+
+        if (!chunk->done) {
+            jobs.window = jobs.chunk_count;
+            jobs_worker(&jobs);
+        }
+
+        output_write(out, chunk->out, chunk->out_len);
+        count += chunk->count;
+        if (chunk->error) {
+            ok = 0;
+        }
+        free(chunk->out);
+        chunk->out = NULL;
+
+        pthread_mutex_lock(&jobs.lock);
+        jobs.written++;
+        pthread_cond_broadcast(&jobs.cond);
+        pthread_mutex_unlock(&jobs.lock);
+    }
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&jobs.lock);
+    pthread_cond_destroy(&jobs.cond);
+
+cleanup:
+    free(jobs.chunks);
+    return ok ? count : -1;
+}
+
+// 未限制数量（--count为负数）时按时间顺序输出全部匹配记录，否则取最新的filter_num条
+// 指定了时间范围时，只读取稀疏索引或块时间范围表明可能包含匹配记录的部分
+static int log_read(log_output_t *out, log_filter_t *filter, log_streams_t *streams, int jobs) {
+    int opened           = 0;
+    int active           = 0;
+    int count            = -1;
+    log_stream_t *single = NULL;
+
+    for (int i = 0; i < streams->count; i++) {
+        int n = stream_open(&streams->items[i], filter);
+        if (n > 0) {
+            opened += n;
+            active++;
+            single = &streams->items[i];
+        }
+    }
+
+    if (opened > 0) {
+        if (filter->filter_num > 0) {
+            count = log_read_tail(out, filter, streams);
+        } else if (jobs > 1 && active == 1) {
+            count = log_read_jobs(out, filter, single, jobs);
+        } else {
+            count = log_read_merge(out, filter, streams);
+        }
+    }
+
+    for (int i = 0; i < streams->count; i++) {
+        stream_close(&streams->items[i]);
+    }
+    return count;
+}
+
+// 输出scan中新增的匹配记录
+static void follow_drain(log_scan_t *scan, log_filter_t *filter, log_output_t *out) {
+    log_record_t record;
+
+    while (log_scan_next(scan, &record)) {
+        if (log_filter_match(filter, &record)) {
+            output_record(out, &record, filter);
+        }
+    }
+    output_flush(out);
+}
+
+// --follow中跟随的一个当前日志文件（SE_LOG或某个分片）
+typedef struct follow_file_t {
+    char base[256];
+    int wd; // 所在目录的inotify监视
+    log_scan_t scan;
+    ino_t ino;
+    int opened;
+    int reopen;
+} follow_file_t;
+
+// 打开当前日志文件用于跟随，offset为开始读取的位置，-1表示从末尾开始
+static int follow_open(follow_file_t *file, long long offset) {
+    struct stat st;
+
+    if (log_scan_open(&file->scan, file->base, 1) < 0) {
+        return -1;
+    }
+
+    if (fstat(file->scan.fd, &st) < 0) {
+        log_scan_close(&file->scan);
+        return -1;
+    }
+    file->ino = st.st_ino;
+
+    if (offset < 0) {
+        offset = lseek(file->scan.fd, 0, SEEK_END);
+    }
+    if (offset > 0 && log_scan_seek(&file->scan, offset) < 0) {
+        log_scan_close(&file->scan);
+        return -1;
+    }
+    return 0;
+}
+
+static follow_file_t *follow_add(follow_file_t **files, int *count, int *cap, const char *base, int wd) {
+    for (int i = 0; i < *count; i++) {
+        if (strcmp((*files)[i].base, base) == 0) {
+            return NULL;
+        }
+    }
+
+    if (*count == *cap) {
+        int grown_cap        = *cap ? *cap * 2 : 16;
+        follow_file_t *grown = realloc(*files, grown_cap * sizeof(follow_file_t));
+        if (!grown) {
+            return NULL;
+        }
+        *files = grown;
+        *cap   = grown_cap;
+    }
+
+    follow_file_t *file = &(*files)[(*count)++];
+    memset(file, 0, sizeof(*file));
+    snprintf(file->base, sizeof(file->base), "%s", base);
+    file->wd = wd;
+    return file;
+}
+
+// 加入分片目录中新出现的分片，从头读取
+static void follow_add_shards(follow_file_t **files, int *count, int *cap, log_filter_t *filter, int wd) {
+    char base[256];
+    DIR *dir = opendir(SE_LOG_SHARD_DIR);
+    struct dirent *entry;
+
+    while (dir && (entry = readdir(dir))) {
+        if (snprintf(base, sizeof(base), "%s/%s", SE_LOG_SHARD_DIR, entry->d_name) >= (int)sizeof(base) ||
+            !shard_file(entry->d_name) || !shard_wanted(filter, base)) {
+            continue;
+        }
+        follow_file_t *file = follow_add(files, count, cap, base, wd);
+        if (file) {
+            file->reopen = 1;
+        }
+    }
+    if (dir) {
+        closedir(dir);
+    }
+}
+
+// --follow：输出已有日志后，通过inotify监视SE_DIR及分片目录，持续输出新追加的匹配记录
+// 日志文件被重命名轮转、删除或截断时，先读完旧文件，再从头读取新文件；新出现的分片从头读取
+// 各文件的新记录按到达的顺序输出，不再跨文件按时间合并
+static int log_follow(log_filter_t *filter, log_output_t *out, log_streams_t *streams) {
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    const uint32_t mask    = IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+    const char *shard_name = strrchr(SE_LOG_SHARD_DIR, '/') + 1;
+    follow_file_t *files   = NULL;
+    int file_count         = 0;
+    int file_cap           = 0;
+    struct stat st;
+
+    int fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    int dir_wd = inotify_add_watch(fd, SE_DIR, mask);
+    if (dir_wd < 0) {
+        close(fd);
+        return -1;
+    }
+    int shard_wd = inotify_add_watch(fd, SE_LOG_SHARD_DIR, mask);
+
+    // 先建立监视再打开文件，避免漏掉之间发生的轮转
+    for (int i = 0; i < streams->count; i++) {
+        log_stream_t *stream = &streams->items[i];
+        follow_file_t *file  = follow_add(&files, &file_count, &file_cap, stream->base, (i == 0) ? dir_wd : shard_wd);
+        if (!file) {
+            continue;
+        }
+
+        if (stat(file->base, &st) == 0 && st.st_ino == stream->end_ino) {
+            file->opened = follow_open(file, stream->end_offset) == 0;
+        } else {
+            file->opened = follow_open(file, stream->end_ino ? 0 : -1) == 0;
+        }
+        if (file->opened) {
+            follow_drain(&file->scan, filter, out);
+        }
+    }
+
+    while (!out->error) {
+        ssize_t len = read(fd, events, sizeof(events));
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        for (char *p = events; p < events + len; p += sizeof(struct inotify_event) + ((struct inotify_event *)p)->len) {
+            struct inotify_event *event = (struct inotify_event *)p;
+            if (event->len == 0 || (event->mask & IN_MODIFY)) {
+                continue;
+            }
+
+            // 分片目录在跟随期间才被创建
+            if (event->wd == dir_wd && shard_wd < 0 && strcmp(event->name, shard_name) == 0) {
+                shard_wd = inotify_add_watch(fd, SE_LOG_SHARD_DIR, mask);
+                if (shard_wd >= 0) {
+                    follow_add_shards(&files, &file_count, &file_cap, filter, shard_wd);
+                }
+                continue;
+            }
+
+            if (event->wd == shard_wd && (event->mask & (IN_CREATE | IN_MOVED_TO)) && shard_file(event->name)) {
+                char base[256];
+                snprintf(base, sizeof(base), "%s/%s", SE_LOG_SHARD_DIR, event->name);
+                follow_file_t *file;
+                if (shard_wanted(filter, base) && (file = follow_add(&files, &file_count, &file_cap, base, shard_wd))) {
+                    file->reopen = 1;
+                    continue;
+                }
+            }
+
+            for (int i = 0; i < file_count; i++) {
+                if (files[i].wd == event->wd && strcmp(event->name, strrchr(files[i].base, '/') + 1) == 0) {
+                    files[i].reopen = 1;
+                }
+            }
+        }
+
+        for (int i = 0; i < file_count && !out->error; i++) {
+            follow_file_t *file = &files[i];
+
+            if (file->opened) {
+                // 被截断时从头读取
+                if (fstat(file->scan.fd, &st) == 0 && st.st_size < file->scan.base + (long long)file->scan.end) {
+                    log_scan_seek(&file->scan, 0);
+                }
+                follow_drain(&file->scan, filter, out);
+            }
+
+            // 日志文件被替换：读完旧文件中剩余的部分后切换到新文件
+            if ((file->reopen || !file->opened) && stat(file->base, &st) == 0 && !(file->opened && st.st_ino == file->ino)) {
+                if (file->opened) {
+                    follow_drain(&file->scan, filter, out);
+                    file->scan.eof = 1;
+                    follow_drain(&file->scan, filter, out);
+                    log_scan_close(&file->scan);
+                }
+                file->opened = follow_open(file, 0) == 0;
+                if (file->opened) {
+                    follow_drain(&file->scan, filter, out);
+                }
+            }
+            file->reopen = 0;
+        }
+    }
+
+    for (int i = 0; i < file_count; i++) {
+        if (files[i].opened) {
+            log_scan_close(&files[i].scan);
+        }
+    }
+    free(files);
+    close(fd);
+    return -1;
+}
+
+static int parse_int_list(const char *str, int **result, unsigned int *count) {
+    if (!str || !*str)
+        return -1;
+
+    char *copy = strdup(str);
+    if (!copy)
+        return -1;
+
+    // 计算元素数量
+    *count = 1;
+    for (char *p = copy; *p; p++) {
+        if (*p == ',')
+            (*count)++;
+    }
+
+    // 分配内存
+    *result = malloc(*count * sizeof(int));
+    if (!*result) {
+        free(copy);
+        return -1;
+    }
+
+    // 解析每个元素
+    char *token = strtok(copy, ",");
+    unsigned int i = 0;
+    for (; i < *count && token; i++) {
+        (*result)[i] = atoi(token);
+        token        = strtok(NULL, ",");
+    }
+    *count = i; // strtok会跳过空元素
+
+    free(copy);
+    return 0;
+}
+
+// 解析逗号分隔的字符串列表
+static int parse_str_list(const char *str, char ***result, unsigned int *count) {
+    if (!str || !*str)
+        return -1;
+
+    char *copy = strdup(str);
+    if (!copy)
+        return -1;
+
+    // 计算元素数量
+    *count = 1;
+    for (char *p = copy; *p; p++) {
+        if (*p == ',')
+            (*count)++;
+    }
+
+    // 分配内存
+    *result = malloc(*count * sizeof(char *));
+    if (!*result) {
+        free(copy);
+        return -1;
+    }
+
+    // 解析每个元素
+    char *token = strtok(copy, ",");
+    unsigned int i = 0;
+    for (; i < *count && token; i++) {
+        (*result)[i] = strdup(token);
+        token        = strtok(NULL, ",");
+    }
+    *count = i; // strtok会跳过空元素
+
+    free(copy);
+    return 0;
+}
+
+
+int log_read_main(int argc, char *argv[]) {
+
+
+    log_filter_t filter = {0};
+    char *output_file   = NULL;
+    log_output_t out    = {.fd = STDOUT_FILENO, .limit = LOG_OUTPUT_FIRST_FLUSH};
+    log_streams_t streams = {0};
+    log_stats_t stats   = {0};
+    char *bucket        = NULL;
+    int follow          = 0;
+    int jobs            = 1;
+    int stats_mode      = 0;
+
+    // 定义长选项
+    static struct option long_options[] = {
+        {"start-time", required_argument, 0, 's'},
+        {"end-time", required_argument, 0, 'e'},
+        {"type", required_argument, 0, 't'},
+        {"exclude-type", required_argument, 0, 'x'},
+        {"pid", required_argument, 0, 'p'},
+        {"exclude-pid", required_argument, 0, 'X'},
+        {"path", required_argument, 0, 'P'},
+        {"exclude-path", required_argument, 0, 'E'},
+        {"name", required_argument, 0, 'n'},
+        {"exclude-name", required_argument, 0, 'N'},
+        {"count", required_argument, 0, 'c'},
+        {"human-time", no_argument, 0, 'H'},
+        {"no-timestamp", no_argument, 0, 0},
+        {"no-type", no_argument, 0, 0},
+        {"no-pid", no_argument, 0, 0},
+        {"no-path", no_argument, 0, 0},
+        {"no-name", no_argument, 0, 0},
+        {"output", required_argument, 0, 'o'},
+        {"follow", no_argument, 0, 'f'},
+        {"jobs", required_argument, 0, 'j'},
+        {"stats", no_argument, 0, 0},
+        {"bucket", required_argument, 0, 0},
+        {0, 0, 0, 0}};
+
+    int opt;
+    int option_index = 0;
+
+    while ((opt = getopt_long(argc, argv, "hs:e:t:x:p:X:P:E:n:N:c:Ho:fj:", long_options, &option_index)) != -1) {
+        switch (opt) {
+            
+        case 's':
+            filter.filter_time_start = atol(optarg);
+            break;
+
+        case 'e':
+            filter.filter_time_end = atol(optarg);
+            break;
+
+        case 't':
+            if (parse_int_list(optarg, &filter.filter_type, &filter.filter_type_size) != 0) {
+                fprintf(stderr, "Failed to parse type list\n");
+                return 1;
+            }
+            break;
+
+        case 'x':
+            if (parse_int_list(optarg, &filter.filter_exclude_type, &filter.filter_exclude_type_size) != 0) {
+                fprintf(stderr, "Failed to parse exclude type list\n");
+                return 1;
+            }
+            break;
+
+        case 'p':
+            if (parse_int_list(optarg, &filter.filter_pid, &filter.filter_pid_size) != 0) {
+                fprintf(stderr, "Failed to parse PID list\n");
+                return 1;
+            }
+            break;
+
+        case 'X':
+            if (parse_int_list(optarg, &filter.filter_exclude_pid, &filter.filter_exclude_pid_size) != 0) {
+                fprintf(stderr, "Failed to parse exclude PID list\n");
+                return 1;
+            }
+            break;
+
+        case 'P':
+            if (parse_str_list(optarg, &filter.filter_path, &filter.filter_path_size) != 0) {
+                fprintf(stderr, "Failed to parse path list\n");
+                return 1;
+            }
+            break;
+
+        case 'E':
+            if (parse_str_list(optarg, &filter.filter_exclude_path, &filter.filter_exclude_path_size) != 0) {
+                fprintf(stderr, "Failed to parse exclude path list\n");
+                return 1;
+            }
+            break;
+
+        case 'n':
+            if (parse_str_list(optarg, &filter.filter_name, &filter.filter_name_size) != 0) {
+                fprintf(stderr, "Failed to parse name list\n");
+                return 1;
+            }
+            break;
+
+        case 'N':
+            if (parse_str_list(optarg, &filter.filter_exclude_name, &filter.filter_exclude_name_size) != 0) {
+                fprintf(stderr, "Failed to parse exclude name list\n");
+                return 1;
+            }
+            break;
+
+        case 'c':
+            filter.filter_num = atoi(optarg);
+            break;
+
+        case 'H':
+            filter.flag |= LOG_FILTER_FLAG_human_time;
+            break;
+
+        case 'o':
+            output_file = strdup(optarg);
+            break;
+
+        case 'f':
+            follow = 1;
+            break;
+
+        case 'j':
+            jobs = atoi(optarg);
+            if (jobs < 1 || jobs > LOG_JOBS_MAX) {
+                fprintf(stderr, "Invalid jobs: %s\n", optarg);
+                return 1;
+            }
+            break;
+
+        case 0:
+            // 处理无短选项的长选项
+            if (strcmp(long_options[option_index].name, "no-timestamp") == 0) {
+                filter.flag |= LOG_FILTER_FLAG_exclude_timestamp;
+            } else if (strcmp(long_options[option_index].name, "no-type") == 0) {
+                filter.flag |= LOG_FILTER_FLAG_exclude_type;
+            } else if (strcmp(long_options[option_index].name, "no-pid") == 0) {
+                filter.flag |= LOG_FILTER_FLAG_exclude_pid;
+            } else if (strcmp(long_options[option_index].name, "no-path") == 0) {
+                filter.flag |= LOG_FILTER_FLAG_exclude_path;
+            } else if (strcmp(long_options[option_index].name, "no-name") == 0) {
+                filter.flag |= LOG_FILTER_FLAG_exclude_name;
+            } else if (strcmp(long_options[option_index].name, "stats") == 0) {
+                stats_mode = 1;
+            } else if (strcmp(long_options[option_index].name, "bucket") == 0) {
+                if (parse_bucket(optarg) < 0) {
+                    fprintf(stderr, "Invalid bucket: %s\n", optarg);
+                    return 1;
+                }
+                stats_mode = 1;
+                bucket     = optarg;
+            }
+            break;
+
+        default:
+            fprintf(stderr, "Unknown option. Use -h for help.\n");
+            return 1;
+        }
+    }
+
+    if (filter.filter_num == 0){
+        filter.filter_num = LOG_DEFAULT_COUNT;
+    }
+
+    // --stats统计时间范围内全部匹配的记录，单线程读取，不跟随
+    if (stats_mode) {
+        if (log_stats_init(&stats, bucket ? parse_bucket(bucket) : 0) < 0) {
+            fprintf(stderr, "Failed to allocate stats\n");
+            goto cleanup;
+        }
+        out.stats         = &stats;
+        filter.filter_num = -1;
+        jobs              = 1;
+        follow            = 0;
+    }
+
+    if (log_filter_compile(&filter) < 0) {
+        fprintf(stderr, "Failed to compile filter\n");
+        goto cleanup;
+    }
+
+    // 分配输出缓冲区
+    out.buffer = malloc(LOG_OUTPUT_BUFFER_SIZE);
+    if (!out.buffer) {
+        fprintf(stderr, "Failed to allocate buffer\n");
+        goto cleanup;
+    }
+
+    // 打开输出文件
+    if (output_file) {
+        out.fd = open(output_file, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        if (out.fd < 0) {
+            fprintf(stderr, "Failed to open output file: %s\n", output_file);
+            goto cleanup;
+        }
+    }
+
+    if (streams_find(&streams, &filter) < 0) {
+        fprintf(stderr, "Failed to find log files\n");
+        goto cleanup;
+    }
+
+    // 读取日志，边读边输出
+    int count = log_read(&out, &filter, &streams, jobs);
+    if (stats_mode && count >= 0) {
+        if (stats.error) {
+            fprintf(stderr, "Failed to allocate stats\n");
+            goto cleanup;
+        }
+        out.stats = NULL;
+        stats_print(&out, &filter, &stats, bucket);
+    }
+    output_flush(&out);
+    if (count < 0 && !follow) {
+        fprintf(stderr, "Failed to read log\n");
+        goto cleanup;
+    }
+
+    if (follow && !out.error && log_follow(&filter, &out, &streams) < 0) {
+        perror("follow " SE_LOG);
+    }
+
+cleanup:
+    // 清理资源
+    if (out.buffer)
+        free(out.buffer);
+    if (output_file)
+        free(output_file);
+    if (out.fd >= 0 && out.fd != STDOUT_FILENO)
+        close(out.fd);
+
+    log_filter_free(&filter);
+    log_stats_free(&stats);
+    free(streams.items);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,526 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "se-boot-src/log_record.h"
+
+// 二进制记录: 头部 | path | name | msg | 尾部
+// 尾部重复记录总长度，便于从文件末尾向前遍历
+typedef struct __attribute__((packed)) log_bin_head_t {
+    uint8_t magic[2];
+    uint16_t type;
+    int32_t pid;
+    int64_t timestamp;
+    uint16_t path_len;
+    uint16_t name_len;
+    uint32_t msg_len;
+    uint32_t crc; // CRC32C，覆盖crc为0时的头部与全部字段
+} log_bin_head_t;
+
+typedef struct __attribute__((packed)) log_bin_tail_t {
+    uint32_t size;
+    uint8_t magic[2];
+} log_bin_tail_t;
+
+_Static_assert(sizeof(log_bin_head_t) == LOG_RECORD_BIN_HEAD_SIZE, "binary log head size");
+_Static_assert(sizeof(log_bin_tail_t) == LOG_RECORD_BIN_TAIL_SIZE, "binary log tail size");
+
+static uint32_t crc32c_table[256];
+
+static void crc32c_init() {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ (0x82f63b78 & -(crc & 1));
+        }
+        crc32c_table[i] = crc;
+    }
+}
+
+uint32_t log_crc32c(uint32_t crc, const void *data, size_t size) {
+    const uint8_t *p = data;
+
+    if (crc32c_table[1] == 0) {
+        crc32c_init();
+    }
+
+    crc = ~crc;
+    while (size--) {
+        crc = crc32c_table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// 写入格式，由环境变量SE_LOG_FORMAT控制（text/binary）
+int log_record_format() {
+    static int format = -1;
+    if (format < 0) {
+        const char *value = getenv("SE_LOG_FORMAT");
+        format            = (value && strcmp(value, "binary") == 0) ? LOG_FORMAT_BINARY : LOG_FORMAT_TEXT;
+    }
+    return format;
+}
+
+static size_t encode_text(char *buffer, const log_record_t *record) {
+    int len = snprintf(buffer, LOG_RECORD_MAX_SIZE, "[%ld][%d][%d][%.*s][%.*s]:", record->timestamp, record->type, record->pid,
+                       (int)record->path_len, record->path, (int)record->name_len, record->name);
+
+    // 过长时截断，保留换行符的位置
+    if (len > LOG_RECORD_MAX_SIZE - 1) {
+        len = LOG_RECORD_MAX_SIZE - 1;
+    }
+
+    size_t msg_len = record->msg_len;
+    if (msg_len > (size_t)(LOG_RECORD_MAX_SIZE - 1 - len)) {
+        msg_len = LOG_RECORD_MAX_SIZE - 1 - len;
+    }
+
+    memcpy(buffer + len, record->msg, msg_len);
+    len += msg_len;
+    buffer[len++] = '\n';
+    return len;
+}
+
+static size_t encode_binary(char *buffer, const log_record_t *record) {
+    log_bin_head_t head;
+    log_bin_tail_t tail;
+
+    head.magic[0]  = LOG_RECORD_BIN_MAGIC0;
+    head.magic[1]  = LOG_RECORD_BIN_MAGIC1;
+    head.type      = record->type;
+    head.pid       = record->pid;
+    head.timestamp = record->timestamp;
+    head.path_len  = record->path_len > LOG_RECORD_MAX_FIELD ? LOG_RECORD_MAX_FIELD : record->path_len;
+    head.name_len  = record->name_len > LOG_RECORD_MAX_FIELD ? LOG_RECORD_MAX_FIELD : record->name_len;
+    head.crc       = 0;
+
+    size_t room  = LOG_RECORD_MAX_SIZE - LOG_RECORD_BIN_HEAD_SIZE - LOG_RECORD_BIN_TAIL_SIZE - head.path_len - head.name_len;
+    head.msg_len = record->msg_len > room ? room : record->msg_len;
+
+    char *p = buffer + LOG_RECORD_BIN_HEAD_SIZE;
+    memcpy(p, record->path, head.path_len);
+    p += head.path_len;
+    memcpy(p, record->name, head.name_len);
+    p += head.name_len;
+    memcpy(p, record->msg, head.msg_len);
+    p += head.msg_len;
+
+    size_t size = (p - buffer) + LOG_RECORD_BIN_TAIL_SIZE;
+    memcpy(buffer, &head, sizeof(head));
+    head.crc = log_crc32c(0, buffer, p - buffer);
+    memcpy(buffer, &head, sizeof(head));
+
+    tail.size     = size;
+    tail.magic[0] = LOG_RECORD_BIN_MAGIC1;
+    tail.magic[1] = LOG_RECORD_BIN_MAGIC0;
+    memcpy(p, &tail, sizeof(tail));
+
+    return size;
+}
+
+// 将记录编码到buffer（至少LOG_RECORD_MAX_SIZE字节），返回编码后的长度
+size_t log_record_encode(char *buffer, const log_record_t *record, int format) {
+    if (format == LOG_FORMAT_BINARY) {
+        return encode_binary(buffer, record);
+    }
+    return encode_text(buffer, record);
+}
+
+// 解析"[数字]"，返回下一个位置，失败返回NULL
+static const char *parse_number(const char *p, const char *end, long *value) {
+    if (p >= end || *p != '[') {
+        return NULL;
+    }
+    p++;
+
+    int negative = 0;
+    if (p < end && *p == '-') {
+        negative = 1;
+        p++;
+    }
+
+    const char *start = p;
+    long result       = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        result = result * 10 + (*p - '0');
+        p++;
+    }
+
+    if (p == start || p >= end || *p != ']') {
+        return NULL;
+    }
+
+    *value = negative ? -result : result;
+    return p + 1;
+}
+
+// 解析"[字符串]"，字符串中不能含有'['、']'或换行
+static const char *parse_field(const char *p, const char *end, const char **field, unsigned int *len) {
+    if (p >= end || *p != '[') {
+        return NULL;
+    }
+    p++;
+
+    const char *start = p;
+    while (p < end && *p != ']' && *p != '[' && *p != '\n') {
+        p++;
+    }
+
+    if (p == start || p >= end || *p != ']') {
+        return NULL;
+    }
+
+    *field = start;
+    *len   = p - start;
+    return p + 1;
+}
+
+// 单遍解析：依次解析各字段，消息部分再用memchr找到行尾
+static int parse_text(const char *buffer, size_t size, int eof, log_record_t *record) {
+    const char *limit = buffer + size;
+    const char *p     = buffer;
+    const char *end;
+    long timestamp, type, pid;
+
+    if (!(p = parse_number(p, limit, &timestamp)) ||
+        !(p = parse_number(p, limit, &type)) ||
+        !(p = parse_number(p, limit, &pid)) ||
+        !(p = parse_field(p, limit, &record->path, &record->path_len)) ||
+        !(p = parse_field(p, limit, &record->name, &record->name_len)) ||
+        p >= limit || *p != ':') {
+        // 无效的行整行跳过；数据不完整时可能只是还没读到，等待更多数据
+        end = memchr(buffer, '\n', size);
+        if (end) {
+            return -(int)(end - buffer + 1);
+        }
+        return eof ? -(int)size : 0;
+    }
+    p++;
+
+    size_t line_len;
+    end = memchr(p, '\n', limit - p);
+    if (end) {
+        line_len = end - buffer + 1;
+    } else if (eof) {
+        // 文件末尾不完整的行（写入被中断）也尝试解析
+        end      = limit;
+        line_len = size;
+    } else {
+        return 0;
+    }
+
+    record->timestamp = timestamp;
+    record->type      = type;
+    record->pid       = pid;
+    record->msg       = p;
+    record->msg_len   = end - p;
+    return line_len;
+}
+
+static int parse_binary(const char *buffer, size_t size, int eof, log_record_t *record) {
+    log_bin_head_t head;
+    log_bin_tail_t tail;
+
+    if (size < LOG_RECORD_BIN_HEAD_SIZE) {
+        return eof ? -1 : 0;
+    }
+
+    memcpy(&head, buffer, sizeof(head));
+    size_t payload = (size_t)head.path_len + head.name_len + head.msg_len;
+    size_t total   = LOG_RECORD_BIN_HEAD_SIZE + payload + LOG_RECORD_BIN_TAIL_SIZE;
+
+    if (head.path_len > LOG_RECORD_MAX_FIELD || head.name_len > LOG_RECORD_MAX_FIELD || total > LOG_RECORD_MAX_SIZE) {
+        return -1;
+    }
+
+    if (size < total) {
+        return eof ? -1 : 0;
+    }
+
+    memcpy(&tail, buffer + total - LOG_RECORD_BIN_TAIL_SIZE, sizeof(tail));
+    if (tail.size != total || tail.magic[0] != LOG_RECORD_BIN_MAGIC1 || tail.magic[1] != LOG_RECORD_BIN_MAGIC0) {
+        return -1;
+    }
+
+    // 校验CRC，检测崩溃时未写完的记录
+    uint32_t crc = head.crc;
+    head.crc     = 0;
+    uint32_t sum = log_crc32c(0, &head, sizeof(head));
+    sum          = log_crc32c(sum, buffer + LOG_RECORD_BIN_HEAD_SIZE, payload);
+    if (sum != crc) {
+        return -1;
+    }
+
+    const char *p     = buffer + LOG_RECORD_BIN_HEAD_SIZE;
+    record->timestamp = head.timestamp;
+    record->type      = head.type;
+    record->pid       = head.pid;
+    record->path      = p;
+    record->path_len  = head.path_len;
+    record->name      = p + head.path_len;
+    record->name_len  = head.name_len;
+    record->msg       = p + head.path_len + head.name_len;
+    record->msg_len   = head.msg_len;
+    return total;
+}
+
+// 跳过无法解析的数据，直到下一个可能的记录开头（行首或二进制魔数）
+static int resync(const char *buffer, size_t size) {
+    for (size_t i = 1; i < size; i++) {
+        if (buffer[i - 1] == '\n' || (unsigned char)buffer[i] == LOG_RECORD_BIN_MAGIC0) {
+            return -(int)i;
+        }
+    }
+    return -(int)size;
+}
+
+// 从buffer开头解析一条记录
+// 返回值>0: 记录长度；0: 数据不完整，需要更多数据；<0: 无效数据，调用者应跳过-返回值个字节
+// eof非0表示buffer之后没有更多数据
+int log_record_parse(const char *buffer, size_t size, int eof, log_record_t *record) {
+    if (size == 0) {
+        return 0;
+    }
+
+    if ((unsigned char)buffer[0] == LOG_RECORD_BIN_MAGIC0) {
+        if (size < 2 && !eof) {
+            return 0;
+        }
+        if (size >= 2 && (unsigned char)buffer[1] == LOG_RECORD_BIN_MAGIC1) {
+            int ret = parse_binary(buffer, size, eof, record);
+            if (ret >= 0) {
+                return ret;
+            }
+        }
+        return resync(buffer, size);
+    }
+
+    if (buffer[0] == '[') {
+        return parse_text(buffer, size, eof, record);
+    }
+
+    return resync(buffer, size);
+}
+
+// follow为0时将整个文件映射到内存，记录字段直接指向映射区，不做任何复制；
+// follow非0时用于跟随仍在追加的文件，通过缓冲区逐块读取
+int log_scan_open(log_scan_t *scan, const char *path, int follow) {
+    struct stat st;
+
+    scan->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (scan->fd < 0) {
+        return -1;
+    }
+
+    scan->eof    = 0;
+    scan->follow = follow;
+    scan->buffer = NULL;
+    scan->start  = 0;
+    scan->end    = 0;
+    scan->base   = 0;
+
+    if (follow) {
+        scan->buffer = malloc(LOG_SCAN_BUFFER_SIZE);
+        if (!scan->buffer) {
+            close(scan->fd);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (fstat(scan->fd, &st) < 0) {
+        close(scan->fd);
+        return -1;
+    }
+
+    // 只读取打开时的文件大小
+    scan->eof = 1;
+    scan->end = st.st_size;
+    if (st.st_size > 0) {
+        void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, scan->fd, 0);
+        if (data == MAP_FAILED) {
+            close(scan->fd);
+            return -1;
+        }
+        madvise(data, st.st_size, MADV_SEQUENTIAL);
+        scan->buffer = data;
+    }
+    return 0;
+}
+
+// 跳到文件中的指定偏移，偏移应为记录的起始位置
+int log_scan_seek(log_scan_t *scan, long long offset) {
+    if (!scan->follow) {
+        if (offset < 0 || (size_t)offset > scan->end) {
+            return -1;
+        }
+        scan->start = offset;
+        return 0;
+    }
+
+    if (lseek(scan->fd, offset, SEEK_SET) < 0) {
+        return -1;
+    }
+
+    scan->eof   = 0;
+    scan->start = 0;
+    scan->end   = 0;
+    scan->base  = offset;
+    return 0;
+}
+
+// 下一条记录在文件中的偏移
+long long log_scan_offset(log_scan_t *scan) {
+    return scan->base + scan->start;
+}
+
+// 读取下一条记录，成功返回1，文件结束返回0
+// 记录中的字段指向内部缓冲区，在下次调用前有效
+int log_scan_next(log_scan_t *scan, log_record_t *record) {
+    while (1) {
+        size_t size = scan->end - scan->start;
+        // 缓冲区已满仍无法组成完整记录时按文件末尾处理，避免卡住
+        int eof = scan->eof || (scan->start == 0 && scan->end == LOG_SCAN_BUFFER_SIZE);
+        int ret = log_record_parse(scan->buffer + scan->start, size, eof, record);
+
+        if (ret > 0) {
+            scan->start += ret;
+            return 1;
+        }
+
+        if (ret < 0) {
+            scan->start += -ret;
+            continue;
+        }
+
+        if (scan->eof) {
+            return 0;
+        }
+
+        // 将剩余的不完整数据移到开头并读取更多
+        memmove(scan->buffer, scan->buffer + scan->start, size);
+        scan->base += scan->start;
+        scan->start = 0;
+        scan->end   = size;
+
+        // 跟随模式下读到末尾不视为结束，不完整的记录留待之后继续读取
+        ssize_t n = read(scan->fd, scan->buffer + scan->end, LOG_SCAN_BUFFER_SIZE - scan->end);
+        if (n <= 0) {
+            return 0;
+        }
+        scan->end += n;
+    }
+}
+
+void log_scan_close(log_scan_t *scan) {
+    if (scan->follow) {
+        free(scan->buffer);
+    } else if (scan->buffer) {
+        munmap(scan->buffer, scan->end);
+    }
+    close(scan->fd);
+}
+
+// 在内存中的[start, end)范围内读取记录，两者应为记录边界；初始位置为末尾
+void log_rscan_init(log_rscan_t *scan, const char *data, size_t start, size_t end) {
+    scan->data  = data;
+    scan->start = start;
+    scan->end   = end;
+    scan->pos   = end;
+}
+
+// 在end处结束的完整二进制记录的长度，不是则返回0
+static size_t rscan_binary(const char *data, size_t start, size_t end, log_record_t *record) {
+    log_bin_tail_t tail;
+
+    if (end - start < LOG_RECORD_BIN_HEAD_SIZE + LOG_RECORD_BIN_TAIL_SIZE) {
+        return 0;
+    }
+
+    memcpy(&tail, data + end - LOG_RECORD_BIN_TAIL_SIZE, sizeof(tail));
+    if (tail.magic[0] != LOG_RECORD_BIN_MAGIC1 || tail.magic[1] != LOG_RECORD_BIN_MAGIC0 ||
+        tail.size < LOG_RECORD_BIN_HEAD_SIZE + LOG_RECORD_BIN_TAIL_SIZE || tail.size > end - start) {
+        return 0;
+    }
+
+    if (parse_binary(data + end - tail.size, tail.size, 1, record) != (int)tail.size) {
+        return 0;
+    }
+    return tail.size;
+}
+
+// 读取前一条记录，成功返回1，到达开头返回0
+// 记录之间的边界为换行符或二进制记录尾部，二进制记录内部可能含有换行符，因此先检查尾部
+int log_rscan_prev(log_rscan_t *scan, log_record_t *record) {
+    const char *data = scan->data;
+
+    while (scan->pos > scan->start) {
+        size_t end = scan->pos;
+
+        size_t size = rscan_binary(data, scan->start, end, record);
+        if (size > 0) {
+            scan->pos = end - size;
+            return 1;
+        }
+
+        // 向前找到上一条记录的结束位置作为本条记录的开头
+        size_t begin = scan->start;
+        for (size_t i = end - 1; i > scan->start; i--) {
+            if (data[i - 1] == '\n') {
+                begin = i;
+                break;
+            }
+            if ((unsigned char)data[i - 1] == LOG_RECORD_BIN_MAGIC0 && rscan_binary(data, scan->start, i, record) > 0) {
+                begin = i;
+                break;
+            }
+        }
+
+        scan->pos = begin;
+        if (log_record_parse(data + begin, end - begin, 1, record) == (int)(end - begin)) {
+            return 1;
+        }
+        // 无法解析的数据（例如写入被中断的记录）直接跳过
+    }
+
+    return 0;
+}
+
+// 从pos开始找到下一条记录的开头（上一条记录以换行或二进制尾部结束，且从该处能解析出完整记录），
+// 用于将文件切分为可独立解析的块；找不到时返回size
+size_t log_record_sync(const char *data, size_t size, size_t pos) {
+    log_record_t record;
+
+    if (pos == 0) {
+        return 0;
+    }
+
+    for (size_t q = pos; q < size; q++) {
+        int after_text   = data[q - 1] == '\n';
+        int after_binary = (unsigned char)data[q - 1] == LOG_RECORD_BIN_MAGIC0 && rscan_binary(data, 0, q, &record) > 0;
+        if ((after_text || after_binary) && log_record_parse(data + q, size - q, 1, &record) > 0) {
+            return q;
+        }
+    }
+    return size;
+}
+
+// 从pos向后读取下一条记录，成功返回1，到达读取范围末尾返回0
+int log_rscan_next(log_rscan_t *scan, log_record_t *record) {
+    while (scan->pos < scan->end) {
+        int ret = log_record_parse(scan->data + scan->pos, scan->end - scan->pos, 1, record);
+        if (ret > 0) {
+            scan->pos += ret;
+            return 1;
+        }
+        if (ret == 0) {
+            break;
+        }
+        scan->pos += -ret;
+    }
+    return 0;
+}
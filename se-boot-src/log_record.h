@@ -0,0 +1,76 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_LOG_RECORD_H
+#define SE_BOOT_LOG_RECORD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LOG_FORMAT_TEXT 0
+#define LOG_FORMAT_BINARY 1
+
+#define LOG_RECORD_MAX_SIZE (2048)     // 单条记录编码后的最大长度（含换行/尾部）
+#define LOG_RECORD_MAX_FIELD (255)     // 二进制记录中path/name的最大长度
+#define LOG_RECORD_BIN_HEAD_SIZE (28)
+#define LOG_RECORD_BIN_TAIL_SIZE (6)
+#define LOG_SCAN_BUFFER_SIZE (64 * 1024) // 跟随模式读取日志文件的缓冲区
+
+// 二进制记录以不可能出现在文本行首的字节开头，两种格式可在同一文件中混合
+#define LOG_RECORD_BIN_MAGIC0 (0x1e)
+#define LOG_RECORD_BIN_MAGIC1 (0xb5)
+
+// 一条日志记录，字符串字段指向原始数据，不以'\0'结尾
+typedef struct log_record_t {
+    long timestamp;
+    int type;
+    int pid;
+
+    const char *path;
+    unsigned int path_len;
+    const char *name;
+    unsigned int name_len;
+    const char *msg;
+    unsigned int msg_len;
+} log_record_t;
+
+// 顺序读取一个日志文件中的记录，文本与二进制格式可混合
+typedef struct log_scan_t {
+    int fd;
+    int eof;
+    int follow; // 跟随模式：通过缓冲区读取仍在追加的文件，否则buffer为整个文件的映射
+    char *buffer;
+    size_t start;
+    size_t end;
+    long long base; // buffer[0]在文件中的偏移
+} log_scan_t;
+
+// 从末尾向前读取一段内存中的记录（映射的日志文件或解压后的块），用于取最新的若干条；
+// 找到起点后可再从该位置向后读取
+typedef struct log_rscan_t {
+    const char *data;
+    size_t start; // 读取范围[start, end)
+    size_t end;
+    size_t pos; // 向前读取时为下一条（更早的）记录的结束位置，向后读取时为下一条记录的开头
+} log_rscan_t;
+
+int log_record_format();
+size_t log_record_encode(char *buffer, const log_record_t *record, int format);
+int log_record_parse(const char *buffer, size_t size, int eof, log_record_t *record);
+int log_scan_open(log_scan_t *scan, const char *path, int follow);
+int log_scan_seek(log_scan_t *scan, long long offset);
+long long log_scan_offset(log_scan_t *scan);
+int log_scan_next(log_scan_t *scan, log_record_t *record);
+void log_scan_close(log_scan_t *scan);
+size_t log_record_sync(const char *data, size_t size, size_t pos);
+void log_rscan_init(log_rscan_t *scan, const char *data, size_t start, size_t end);
+int log_rscan_prev(log_rscan_t *scan, log_record_t *record);
+int log_rscan_next(log_rscan_t *scan, log_record_t *record);
+uint32_t log_crc32c(uint32_t crc, const void *data, size_t size);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
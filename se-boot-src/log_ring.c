@@ -0,0 +1,417 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include "se-boot-src/log_ring.h"
+#include "se-boot-src/log.h"
+#include "se-boot-src/log_record.h"
+#include "se-boot-src/path.h"
+
+#define LOG_RING_MAGIC (0x53454c52) // "SELR"
+#define LOG_RING_DEFAULT_SLOTS (1024)
+#define LOG_RING_DATA_SIZE LOG_RECORD_MAX_SIZE
+#define LOG_RING_DRAIN_BATCH (256) // 单次writev最多写出的槽位数
+#define LOG_RING_STALL_MS (1000)   // 已预留但迟迟未提交的槽位，超时后跳过
+#define LOG_RING_BLOCK_MS (1000)   // block/spill策略下最多等待的时间，超时后溢出到文件
+#define LOG_RING_BLOCK_SLEEP_US (1000) // block策略下两次尝试之间的睡眠，消费者空闲时按固定间隔轮询，不需要更短
+#define LOG_RING_ABANDONED (1ULL << 63) // 被消费者跳过的槽位，seq为pos|该位，直到预留它的生产者回收前不能再被预留
+
+#define LOG_RING_FULL_SPILL 0 // 环满时等环中已有记录写出后，退回聚合套接字/文件锁写入（默认）
+#define LOG_RING_FULL_DROP 1  // 环满时丢弃并计数
+#define LOG_RING_FULL_BLOCK 2 // 环满时等待消费者腾出空间
+
+// 共享内存布局：头部 + slot_count个定长槽位
+// 生产者以CAS推进head预留槽位（满时需要能放弃预留，因此不用fetch-add），
+// 写完数据后将槽位序号置为pos+1表示提交；消费者按tail顺序读出已提交的槽位。
+// 预留后迟迟未提交的槽位被消费者标记为放弃，由生产者在提交失败时回收（生产者已退出时由消费者回收），
+// 保证槽位在生产者写入期间不会交给其他生产者
+typedef struct log_ring_header_t {
+    uint32_t magic;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    int32_t drainer_pid;
+    uint32_t active;
+    uint32_t reserved;
+
+    uint64_t head __attribute__((aligned(64)));
+    uint64_t tail __attribute__((aligned(64)));
+    uint64_t dropped __attribute__((aligned(64)));
+} log_ring_header_t;
+
+typedef struct log_ring_slot_t {
+    uint64_t seq;
+    uint32_t len;
+    int32_t owner; // 预留该槽位的生产者，用于回收被放弃的槽位
+    char data[LOG_RING_DATA_SIZE];
+} log_ring_slot_t;
+
+static log_ring_header_t *ring = NULL;
+static size_t ring_size        = 0;
+static time_t ring_retry       = 0;
+static int ring_full_policy    = -1;
+static uint32_t ring_slots     = 0; // 映射时校验过的槽位数；环文件对所有用户可写，不使用共享头部中的值
+
+static log_ring_slot_t *ring_slot(uint64_t pos) {
+    log_ring_slot_t *slots = (log_ring_slot_t *)(ring + 1);
+    return &slots[pos & (ring_slots - 1)];
+}
+
+// 是否启用共享内存日志环，由环境变量SE_LOG_RING控制
+int log_ring_enabled() {
+    const char *value = getenv("SE_LOG_RING");
+    return value && atoi(value) > 0;
+}
+
+static int ring_policy() {
+    if (ring_full_policy < 0) {
+        const char *value = getenv("SE_LOG_RING_FULL");
+        ring_full_policy  = LOG_RING_FULL_SPILL;
+        if (value && strcmp(value, "drop") == 0) {
+            ring_full_policy = LOG_RING_FULL_DROP;
+        } else if (value && strcmp(value, "block") == 0) {
+            ring_full_policy = LOG_RING_FULL_BLOCK;
+        }
+    }
+    return ring_full_policy;
+}
+
+static void ring_unmap() {
+    if (ring) {
+        munmap(ring, ring_size);
+        ring = NULL;
+    }
+}
+
+// 映射已有的日志环并校验格式
+static int ring_map(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(log_ring_header_t)) {
+        return -1;
+    }
+
+    void *addr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        return -1;
+    }
+
+    log_ring_header_t *header = addr;
+    uint32_t count            = header->slot_count;
+    if (header->magic != LOG_RING_MAGIC || header->slot_size != sizeof(log_ring_slot_t) ||
+        count == 0 || (count & (count - 1)) != 0 ||
+        st.st_size != (off_t)(sizeof(log_ring_header_t) + (size_t)count * sizeof(log_ring_slot_t))) {
+        munmap(addr, st.st_size);
+        return -1;
+    }
+
+    ring       = header;
+    ring_size  = st.st_size;
+    ring_slots = count;
+    return 0;
+}
+
+// 生产者：按需映射日志环，消费者不在时每秒最多重试一次
+static int ring_attach() {
+    if (ring) {
+        if (__atomic_load_n(&ring->active, __ATOMIC_ACQUIRE)) {
+            return 0;
+        }
+        ring_unmap();
+    }
+
+    time_t now = time(NULL);
+    if (now == ring_retry) {
+        return -1;
+    }
+    ring_retry = now;
+
+    int fd = open(SE_LOG_RING, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    int ret = ring_map(fd);
+    close(fd);
+    if (ret < 0) {
+        return -1;
+    }
+
+    pid_t drainer = ring->drainer_pid;
+    if (!__atomic_load_n(&ring->active, __ATOMIC_ACQUIRE) || (kill(drainer, 0) < 0 && errno == ESRCH)) {
+        ring_unmap();
+        return -1;
+    }
+    return 0;
+}
+
+// 消费者：创建日志环，若已有格式相同的环则沿用以免丢失未写出的记录
+int log_ring_create() {
+    const char *value = getenv("SE_LOG_RING_SLOTS");
+    uint32_t count    = value ? (uint32_t)atoi(value) : LOG_RING_DEFAULT_SLOTS;
+    if (count < 2 || (count & (count - 1)) != 0) {
+        count = LOG_RING_DEFAULT_SLOTS;
+    }
+
+    mode_t mask = umask(0);
+    int fd      = open(SE_LOG_RING, O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    umask(mask);
+    if (fd < 0) {
+        return -1;
+    }
+
+    if (ring_map(fd) < 0 || ring_slots != count) {
+        ring_unmap();
+
+        size_t size = sizeof(log_ring_header_t) + (size_t)count * sizeof(log_ring_slot_t);
+        if (ftruncate(fd, 0) < 0 || ftruncate(fd, size) < 0) {
+            close(fd);
+            return -1;
+        }
+
+        void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+
+        ring             = addr;
+        ring_size        = size;
+        ring->slot_count = count;
+        ring_slots       = count;
+        ring->slot_size  = sizeof(log_ring_slot_t);
+        for (uint32_t i = 0; i < count; i++) {
+            ring_slot(i)->seq = i;
+        }
+        __atomic_store_n(&ring->magic, LOG_RING_MAGIC, __ATOMIC_RELEASE);
+    }
+    close(fd);
+
+    ring->drainer_pid = getpid();
+    __atomic_store_n(&ring->active, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// 消费者退出：通知生产者停止使用，保留环文件以便下次启动时写出剩余记录（可在信号处理函数中调用）
+void log_ring_shutdown() {
+    if (ring) {
+        __atomic_store_n(&ring->active, 0, __ATOMIC_RELEASE);
+    }
+}
+
+// 消费者放弃日志环：通知生产者停止使用并删除环文件
+void log_ring_destroy() {
+    if (ring) {
+        __atomic_store_n(&ring->active, 0, __ATOMIC_RELEASE);
+        ring_unmap();
+        unlink(SE_LOG_RING);
+    }
+}
+
+// 预留一个空槽位，环满返回NULL
+static log_ring_slot_t *ring_reserve(uint64_t *pos) {
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+
+    while (1) {
+        log_ring_slot_t *slot = ring_slot(head);
+        uint64_t seq          = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        int64_t diff          = (int64_t)(seq - head);
+
+        // 被放弃的槽位尚未回收，与环满相同；head已被其他生产者推进时重新读取
+        if (seq & LOG_RING_ABANDONED) {
+            uint64_t current = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+            if (current == head) {
+                return NULL;
+            }
+            head = current;
+            continue;
+        }
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&ring->head, &head, head + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *pos = head;
+                return slot;
+            }
+        } else if (diff < 0) {
+            return NULL;
+        } else {
+            head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static long ring_now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// 生产者：将一条完整记录写入日志环，成功返回0，返回-1时调用者应改用其他方式写入
+int log_ring_push(const struct iovec *iov, int count) {
+    if (ring_attach() < 0) {
+        return -1;
+    }
+
+    size_t total = 0;
+    for (int i = 0; i < count; i++) {
+        total += iov[i].iov_len;
+    }
+    if (total > LOG_RING_DATA_SIZE) {
+        return -1;
+    }
+
+    uint64_t pos;
+    log_ring_slot_t *slot = ring_reserve(&pos);
+
+    if (!slot) {
+        switch (ring_policy()) {
+        case LOG_RING_FULL_DROP:
+            __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+            return 0;
+
+        case LOG_RING_FULL_BLOCK: {
+            long deadline = ring_now_ms() + LOG_RING_BLOCK_MS;
+            while (!(slot = ring_reserve(&pos)) && ring_now_ms() < deadline) {
+                usleep(LOG_RING_BLOCK_SLEEP_US);
+            }
+            if (!slot) {
+                return -1;
+            }
+            break;
+        }
+
+        default: {
+            // 先等消费者写出环中已有的记录（包括本进程之前放入的），调用者再直接写入，避免越过它们
+            uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+            long deadline = ring_now_ms() + LOG_RING_BLOCK_MS;
+            while ((int64_t)(__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) - head) < 0 &&
+                   __atomic_load_n(&ring->active, __ATOMIC_ACQUIRE) && ring_now_ms() < deadline) {
+                usleep(LOG_RING_BLOCK_SLEEP_US);
+            }
+            return -1;
+        }
+        }
+    }
+
+    __atomic_store_n(&slot->owner, getpid(), __ATOMIC_RELAXED);
+
+    size_t len = 0;
+    for (int i = 0; i < count; i++) {
+        memcpy(slot->data + len, iov[i].iov_base, iov[i].iov_len);
+        len += iov[i].iov_len;
+    }
+    slot->len = len;
+
+    // 若消费者已因超时跳过该槽位，提交失败，按丢弃计数并将槽位交还给下一圈的生产者
+    uint64_t expected = pos;
+    if (!__atomic_compare_exchange_n(&slot->seq, &expected, pos + 1, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&slot->owner, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&slot->seq, pos + ring_slots, __ATOMIC_RELEASE);
+    }
+    return 0;
+}
+
+// 消费者：环中已没有记录但tail处的槽位仍是上一圈被放弃的槽位时（生产者预留后退出），
+// 确认预留它的进程已不存在后回收。未记录owner（在预留与记录pid之间退出）时无法确认，不回收
+static void ring_reclaim(uint64_t tail) {
+    log_ring_slot_t *slot = ring_slot(tail);
+    uint64_t expected     = (tail - ring_slots) | LOG_RING_ABANDONED;
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != expected) {
+        return;
+    }
+
+    pid_t owner = __atomic_load_n(&slot->owner, __ATOMIC_RELAXED);
+    if (owner <= 0 || kill(owner, 0) == 0 || errno != ESRCH) {
+        return;
+    }
+    if (__atomic_compare_exchange_n(&slot->seq, &expected, tail, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&slot->owner, 0, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+    }
+}
+
+// 消费者：写出所有已提交的记录，返回写出的记录数
+int log_ring_drain(log_writer_t *writer) {
+    static uint64_t stall_pos   = UINT64_MAX;
+    static long stall_since     = 0;
+    static uint64_t dropped_log = 0;
+
+    struct iovec iov[LOG_RING_DRAIN_BATCH];
+    int total = 0;
+
+    if (!ring) {
+        return 0;
+    }
+
+    while (1) {
+        uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+        int count     = 0;
+
+        while (count < LOG_RING_DRAIN_BATCH) {
+            log_ring_slot_t *slot = ring_slot(tail + count);
+            uint64_t seq          = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+            if (seq != tail + count + 1) {
+                break;
+            }
+            // 长度只读取一次并检查，被改写为超出槽位的值时按丢弃计数，不读出槽位之外的内存
+            uint32_t len = __atomic_load_n(&slot->len, __ATOMIC_RELAXED);
+            if (len > LOG_RING_DATA_SIZE) {
+                len = 0;
+                __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+            }
+            iov[count].iov_base = slot->data;
+            iov[count].iov_len  = len;
+            count++;
+        }
+
+        if (count == 0) {
+            // 槽位已被预留但长时间未提交（生产者可能已崩溃），跳过以免阻塞整个环
+            log_ring_slot_t *slot = ring_slot(tail);
+            uint64_t expected     = tail;
+            if (__atomic_load_n(&ring->head, __ATOMIC_RELAXED) == tail) {
+                ring_reclaim(tail);
+                break;
+            }
+            if (stall_pos != tail) {
+                stall_pos   = tail;
+                stall_since = ring_now_ms();
+                break;
+            }
+            if (ring_now_ms() - stall_since < LOG_RING_STALL_MS) {
+                break;
+            }
+            // 只标记为放弃，生产者可能仍在写入，槽位由它在提交时回收
+            if (__atomic_compare_exchange_n(&slot->seq, &expected, tail | LOG_RING_ABANDONED, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+                __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELAXED);
+            }
+            continue;
+        }
+
+        log_writer_append(writer, iov, count);
+
+        // 释放槽位供生产者再次使用
+        for (int i = 0; i < count; i++) {
+            __atomic_store_n(&ring_slot(tail + i)->seq, tail + i + ring_slots, __ATOMIC_RELEASE);
+        }
+        __atomic_store_n(&ring->tail, tail + count, __ATOMIC_RELAXED);
+        total += count;
+    }
+
+    uint64_t dropped = __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+    if (dropped != dropped_log) {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "log ring full: %llu records dropped", (unsigned long long)(dropped - dropped_log));
+        dropped_log = dropped;
+        log_write(LOG_TYPE_BOOT, getpid(), "/", "se-boot", msg);
+    }
+
+    return total;
+}
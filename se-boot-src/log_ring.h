@@ -0,0 +1,22 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_LOG_RING_H
+#define SE_BOOT_LOG_RING_H
+
+#include <sys/uio.h>
+#include "se-boot-src/log.h"
+
+int log_ring_enabled();
+int log_ring_create();
+void log_ring_shutdown();
+void log_ring_destroy();
+int log_ring_drain(log_writer_t *writer);
+int log_ring_push(const struct iovec *iov, int count);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,146 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <signal.h>
+#include "se-boot-src/log_server.h"
+#include "se-boot-src/log.h"
+#include "se-boot-src/log_ring.h"
+#include "se-boot-src/path.h"
+
+#define LOG_SERVER_BATCH (64) // 单次recvmmsg最多接收的记录数
+#define LOG_SERVER_MSG_SIZE LOG_SEND_MAX_SIZE
+#define LOG_SERVER_RCVBUF (4 * 1024 * 1024) // 套接字接收缓冲区
+#define LOG_SERVER_RING_POLL_MS (10)        // 日志环空闲时的轮询间隔
+
+// 是否启用日志聚合进程，由环境变量SE_LOG_AGGREGATOR控制
+int log_server_enabled() {
+    const char *value = getenv("SE_LOG_AGGREGATOR");
+    return value && atoi(value) > 0;
+}
+
+// 创建并绑定日志聚合套接字，调用者需持有SE_LOCK以保证唯一
+int log_server_open() {
+    int sock_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (sock_fd < 0) {
+        return -1;
+    }
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family         = AF_UNIX;
+    strncpy(addr.sun_path, SE_LOG_SOCK, sizeof(addr.sun_path) - 1);
+
+    // 删除上次残留的套接字文件
+    unlink(SE_LOG_SOCK);
+
+    if (bind(sock_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(sock_fd);
+        return -1;
+    }
+
+    // 允许其他用户运行的后台程序写入
+    chmod(SE_LOG_SOCK, 0666);
+
+    int rcvbuf = LOG_SERVER_RCVBUF;
+    setsockopt(sock_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    return sock_fd;
+}
+
+// 接收套接字中已有的全部记录，一次writev写入日志
+static void server_recv(int sock_fd, log_writer_t *writer) {
+    static char buffers[LOG_SERVER_BATCH][LOG_SERVER_MSG_SIZE];
+    struct mmsghdr msgs[LOG_SERVER_BATCH];
+    struct iovec recv_iov[LOG_SERVER_BATCH];
+    struct iovec write_iov[LOG_SERVER_BATCH];
+
+    while (1) {
+        memset(msgs, 0, sizeof(msgs));
+        for (int i = 0; i < LOG_SERVER_BATCH; i++) {
+            recv_iov[i].iov_base       = buffers[i];
+            recv_iov[i].iov_len        = LOG_SERVER_MSG_SIZE;
+            msgs[i].msg_hdr.msg_iov    = &recv_iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int count = recvmmsg(sock_fd, msgs, LOG_SERVER_BATCH, MSG_DONTWAIT, NULL);
+        if (count <= 0) {
+            return;
+        }
+
+        int iov_count = 0;
+        for (int i = 0; i < count; i++) {
+            if (msgs[i].msg_len == 0) {
+                continue;
+            }
+            write_iov[iov_count].iov_base = buffers[i];
+            write_iov[iov_count].iov_len  = msgs[i].msg_len;
+            iov_count++;
+        }
+
+        if (iov_count > 0) {
+            log_writer_append(writer, write_iov, iov_count);
+        }
+
+        if (count < LOG_SERVER_BATCH) {
+            return;
+        }
+    }
+}
+
+static int server_sock_fd = -1;
+static int server_ring    = 0;
+
+// 收到终止信号时通知生产者改为直接写文件；日志环中未写出的记录保留到下次启动时写出
+static void server_stop(int sig) {
+    (void)sig;
+    if (server_sock_fd >= 0) {
+        unlink(SE_LOG_SOCK);
+    }
+    if (server_ring) {
+        log_ring_shutdown();
+    }
+    _exit(0);
+}
+
+// 聚合进程主循环：作为唯一写入者，写出套接字（sock_fd >= 0时）与共享内存日志环（ring非0时）中的记录
+void log_server_run(int sock_fd, int ring) {
+    log_writer_t writer;
+
+    // 本进程的日志直接写文件，不再发给自己
+    log_set_direct(1);
+
+    // 与process_run一致，保证日志文件对所有用户可写
+    umask(0);
+    log_writer_open(&writer, LOG_TYPE_BOOT, getpid(), "/", "se-boot");
+
+    server_sock_fd = sock_fd;
+    server_ring    = ring;
+    signal(SIGTERM, server_stop);
+    signal(SIGINT, server_stop);
+
+    struct pollfd pfd = {sock_fd, POLLIN, 0};
+
+    while (1) {
+        int drained = ring ? log_ring_drain(&writer) : 0;
+
+        // 日志环没有唤醒机制，空闲时按固定间隔轮询；仅套接字时每秒醒来回收子进程
+        int timeout = ring ? (drained > 0 ? 0 : LOG_SERVER_RING_POLL_MS) : 1000;
+
+        if (poll(&pfd, sock_fd >= 0 ? 1 : 0, timeout) > 0) {
+            server_recv(sock_fd, &writer);
+        }
+
+        while (waitpid(-1, NULL, WNOHANG) > 0) {
+        }
+    }
+}
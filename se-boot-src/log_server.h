@@ -0,0 +1,16 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_LOG_SERVER_H
+#define SE_BOOT_LOG_SERVER_H
+
+int log_server_enabled();
+int log_server_open();
+void log_server_run(int sock_fd, int ring);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
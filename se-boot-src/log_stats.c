@@ -0,0 +1,222 @@
+#include <stdlib.h>
+#include <string.h>
+#include "se-boot-src/log_stats.h"
+
+#define LOG_STATS_INITIAL_CAPACITY (64)
+
+static uint32_t hash_long(long key) {
+    uint64_t h = (uint64_t)key * 0x9e3779b97f4a7c15ull;
+    return (uint32_t)(h >> 32);
+}
+
+// FNV-1a
+static uint32_t hash_str(const char *str, unsigned int len) {
+    uint32_t h = 2166136261u;
+    for (unsigned int i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)str[i]) * 16777619u;
+    }
+    return h;
+}
+
+static int table_init(log_stats_table_t *table, unsigned int capacity) {
+    table->entries = calloc(capacity, sizeof(log_stats_entry_t));
+    table->used    = calloc(capacity, 1);
+    table->mask    = capacity - 1;
+    table->size    = 0;
+    table->recent  = NULL;
+    return (table->entries && table->used) ? 0 : -1;
+}
+
+static void table_free(log_stats_table_t *table) {
+    if (table->entries && table->used) {
+        for (unsigned int i = 0; i <= table->mask; i++) {
+            if (table->used[i]) {
+                free(table->entries[i].name);
+            }
+        }
+    }
+    free(table->entries);
+    free(table->used);
+}
+
+static int entry_equal(const log_stats_entry_t *entry, long key, const char *name, unsigned int name_len, uint32_t hash) {
+    if (!name) {
+        return entry->key == key;
+    }
+    return entry->hash == hash && entry->name_len == name_len && memcmp(entry->name, name, name_len) == 0;
+}
+
+// 容量翻倍并重新插入
+static int table_grow(log_stats_table_t *table) {
+    log_stats_table_t grown;
+    if (table_init(&grown, (table->mask + 1) * 2) < 0) {
+        free(grown.entries);
+        free(grown.used);
+        return -1;
+    }
+
+    for (unsigned int i = 0; i <= table->mask; i++) {
+        if (!table->used[i]) {
+            continue;
+        }
+        unsigned int slot = table->entries[i].hash & grown.mask;
+        while (grown.used[slot]) {
+            slot = (slot + 1) & grown.mask;
+        }
+        grown.entries[slot] = table->entries[i];
+        grown.used[slot]    = 1;
+    }
+    grown.size = table->size;
+
+    free(table->entries);
+    free(table->used);
+    *table = grown;
+    return 0;
+}
+
+// 查找或插入一项；name为NULL时以key为键
+static log_stats_entry_t *table_get(log_stats_table_t *table, long key, const char *name, unsigned int name_len) {
+    log_stats_entry_t *recent = table->recent;
+    if (recent && (name ? (recent->name_len == name_len && memcmp(recent->name, name, name_len) == 0) : recent->key == key)) {
+        return recent;
+    }
+
+    uint32_t hash = name ? hash_str(name, name_len) : hash_long(key);
+
+    unsigned int slot = hash & table->mask;
+    while (table->used[slot]) {
+        if (entry_equal(&table->entries[slot], key, name, name_len, hash)) {
+            table->recent = &table->entries[slot];
+            return table->recent;
+        }
+        slot = (slot + 1) & table->mask;
+    }
+
+    if ((table->size + 1) * 2 > table->mask + 1) {
+        if (table_grow(table) < 0) {
+            return NULL;
+        }
+        slot = hash & table->mask;
+        while (table->used[slot]) {
+            slot = (slot + 1) & table->mask;
+        }
+    }
+
+    log_stats_entry_t *entry = &table->entries[slot];
+    memset(entry, 0, sizeof(*entry));
+    entry->key  = key;
+    entry->hash = hash;
+    if (name) {
+        entry->name = malloc(name_len + 1);
+        if (!entry->name) {
+            return NULL;
+        }
+        memcpy(entry->name, name, name_len);
+        entry->name[name_len] = '\0';
+        entry->name_len       = name_len;
+    }
+
+    table->used[slot] = 1;
+    table->size++;
+    table->recent = entry;
+    return entry;
+}
+
+static void entry_add(log_stats_entry_t *entry, const log_record_t *record) {
+    if (entry->count == 0 || record->timestamp < entry->first) {
+        entry->first = record->timestamp;
+    }
+    if (entry->count == 0 || record->timestamp > entry->last) {
+        entry->last = record->timestamp;
+    }
+    entry->count++;
+    entry->bytes += record->msg_len;
+}
+
+int log_stats_init(log_stats_t *stats, long bucket) {
+    memset(stats, 0, sizeof(*stats));
+    stats->bucket = bucket;
+
+    if (table_init(&stats->names, LOG_STATS_INITIAL_CAPACITY) < 0 || table_init(&stats->pids, LOG_STATS_INITIAL_CAPACITY) < 0 ||
+        table_init(&stats->types, LOG_STATS_INITIAL_CAPACITY) < 0 || table_init(&stats->buckets, LOG_STATS_INITIAL_CAPACITY) < 0) {
+        log_stats_free(stats);
+        return -1;
+    }
+    return 0;
+}
+
+void log_stats_add(log_stats_t *stats, const log_record_t *record) {
+    log_stats_entry_t *name   = table_get(&stats->names, 0, record->name, record->name_len);
+    log_stats_entry_t *pid    = table_get(&stats->pids, record->pid, NULL, 0);
+    log_stats_entry_t *type   = table_get(&stats->types, record->type, NULL, 0);
+    log_stats_entry_t *bucket = NULL;
+
+    if (stats->bucket > 0) {
+        long start = record->timestamp - record->timestamp % stats->bucket;
+        if (record->timestamp < 0 && start != record->timestamp) {
+            start -= stats->bucket;
+        }
+        bucket = table_get(&stats->buckets, start, NULL, 0);
+    }
+
+    if (!name || !pid || !type || (stats->bucket > 0 && !bucket)) {
+        stats->error = 1;
+        return;
+    }
+
+    entry_add(&stats->total, record);
+    entry_add(name, record);
+    entry_add(pid, record);
+    entry_add(type, record);
+    if (bucket) {
+        entry_add(bucket, record);
+    }
+}
+
+static int compare_count(const void *a, const void *b) {
+    const log_stats_entry_t *x = *(const log_stats_entry_t *const *)a;
+    const log_stats_entry_t *y = *(const log_stats_entry_t *const *)b;
+    if (x->count != y->count) {
+        return (x->count < y->count) ? 1 : -1;
+    }
+    if (x->name && y->name) {
+        return strcmp(x->name, y->name);
+    }
+    return (x->key > y->key) - (x->key < y->key);
+}
+
+static int compare_key(const void *a, const void *b) {
+    const log_stats_entry_t *x = *(const log_stats_entry_t *const *)a;
+    const log_stats_entry_t *y = *(const log_stats_entry_t *const *)b;
+    return (x->key > y->key) - (x->key < y->key);
+}
+
+// 返回按条数从多到少（by_key为0）或按键从小到大排列的项，以NULL结尾，由调用者free
+log_stats_entry_t **log_stats_sorted(const log_stats_table_t *table, int by_key) {
+    log_stats_entry_t **sorted = malloc((table->size + 1) * sizeof(log_stats_entry_t *));
+    if (!sorted) {
+        return NULL;
+    }
+
+    unsigned int n = 0;
+    for (unsigned int i = 0; i <= table->mask; i++) {
+        if (table->used[i]) {
+            sorted[n++] = &table->entries[i];
+        }
+    }
+    sorted[n] = NULL;
+
+    qsort(sorted, n, sizeof(log_stats_entry_t *), by_key ? compare_key : compare_count);
+    return sorted;
+}
+
+void log_stats_free(log_stats_t *stats) {
+    table_free(&stats->names);
+    table_free(&stats->pids);
+    table_free(&stats->types);
+    table_free(&stats->buckets);
+    memset(&stats->names, 0, sizeof(stats->names));
+    memset(&stats->pids, 0, sizeof(stats->pids));
+    memset(&stats->types, 0, sizeof(stats->types));
+    memset(&stats->buckets, 0, sizeof(stats->buckets));
+}
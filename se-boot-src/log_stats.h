@@ -0,0 +1,52 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_LOG_STATS_H
+#define SE_BOOT_LOG_STATS_H
+
+#include <stdint.h>
+#include "se-boot-src/log_record.h"
+
+// 一组记录的统计：条数、消息字节数、最早/最晚时间
+typedef struct log_stats_entry_t {
+    long key;       // pid、类型或时间桶的起点
+    char *name;     // 按名称统计时的名称（复制）
+    unsigned int name_len;
+    uint32_t hash;
+    unsigned long count;
+    unsigned long long bytes;
+    long first;
+    long last;
+} log_stats_entry_t;
+
+// 开放寻址哈希表，容量为2的幂，装载率不超过1/2
+typedef struct log_stats_table_t {
+    log_stats_entry_t *entries;
+    unsigned char *used;
+    unsigned int mask;
+    unsigned int size;
+    log_stats_entry_t *recent; // 上一条记录命中的项，同一服务的记录通常连续出现
+} log_stats_table_t;
+
+// --stats：一遍读取中按名称、pid、类型以及时间桶聚合，不格式化任何记录
+typedef struct log_stats_t {
+    long bucket; // 时间桶宽度（毫秒），0表示不统计直方图
+    log_stats_entry_t total;
+    log_stats_table_t names;
+    log_stats_table_t pids;
+    log_stats_table_t types;
+    log_stats_table_t buckets;
+    int error;
+} log_stats_t;
+
+int log_stats_init(log_stats_t *stats, long bucket);
+void log_stats_add(log_stats_t *stats, const log_record_t *record);
+log_stats_entry_t **log_stats_sorted(const log_stats_table_t *table, int by_key);
+void log_stats_free(log_stats_t *stats);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
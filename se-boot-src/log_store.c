@@ -0,0 +1,475 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "se-boot-src/log_store.h"
+#include "se-boot-src/log_record.h"
+#include "se-boot-src/log_index.h"
+#include "se-boot-src/log.h"
+
+// LZ4风格的块压缩：序列 = 标记字节(高4位字面量长度, 低4位匹配长度-4) | 字面量 | 2字节偏移 | 扩展长度
+// 最后一个序列只有字面量；只在单个块内引用，块之间互不依赖
+#define LZ_MIN_MATCH (4)
+#define LZ_HASH_BITS (12)
+#define LZ_LAST_LITERALS (5) // 末尾至少保留的字面量
+#define LZ_MATCH_LIMIT (12)  // 距末尾不足此长度时不再查找匹配
+#define LZ_MAX_OFFSET (65535)
+
+#define LOG_ARCHIVE_MAGIC (0x315a4c53) // "SLZ1"
+
+typedef struct log_archive_head_t {
+    uint32_t magic;
+    uint32_t block_count;
+    uint64_t raw_size;
+    uint64_t table_offset;
+} log_archive_head_t;
+
+static uint32_t read32(const unsigned char *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t lz_hash(uint32_t value) {
+    return (value * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// 写入长度的扩展字节（每字节255，直到不足255）
+static unsigned char *lz_put_length(unsigned char *op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = len;
+    return op;
+}
+
+size_t log_lz_bound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+// 压缩到dst，dst至少为log_lz_bound(size)字节，返回压缩后的大小
+size_t log_lz_compress(const char *source, size_t size, char *dest) {
+    uint32_t table[1 << LZ_HASH_BITS];
+    const unsigned char *src    = (const unsigned char *)source;
+    const unsigned char *ip     = src;
+    const unsigned char *anchor = src;
+    const unsigned char *end    = src + size;
+    const unsigned char *limit  = size > LZ_MATCH_LIMIT ? end - LZ_MATCH_LIMIT : src;
+    unsigned char *op           = (unsigned char *)dest;
+
+    memset(table, 0xff, sizeof(table));
+
+    while (ip < limit) {
+        uint32_t sequence = read32(ip);
+        uint32_t hash     = lz_hash(sequence);
+        uint32_t ref      = table[hash];
+        table[hash]       = ip - src;
+
+        if (ref == UINT32_MAX || (ip - src) - ref > LZ_MAX_OFFSET || read32(src + ref) != sequence) {
+            ip++;
+            continue;
+        }
+
+        const unsigned char *match = src + ref;
+        size_t len                 = LZ_MIN_MATCH;
+        while (ip + len < end - LZ_LAST_LITERALS && ip[len] == match[len]) {
+            len++;
+        }
+
+        size_t literal        = ip - anchor;
+        size_t extra          = len - LZ_MIN_MATCH;
+        unsigned char *token  = op++;
+        *token                = ((literal >= 15 ? 15 : literal) << 4) | (extra >= 15 ? 15 : extra);
+        if (literal >= 15) {
+            op = lz_put_length(op, literal - 15);
+        }
+        memcpy(op, anchor, literal);
+        op += literal;
+
+        size_t offset = ip - match;
+        *op++         = offset & 0xff;
+        *op++         = offset >> 8;
+        if (extra >= 15) {
+            op = lz_put_length(op, extra - 15);
+        }
+
+        ip += len;
+        anchor = ip;
+        if (ip - 2 < limit) {
+            table[lz_hash(read32(ip - 2))] = ip - 2 - src;
+        }
+    }
+
+    size_t literal = end - anchor;
+    *op++          = (literal >= 15 ? 15 : literal) << 4;
+    if (literal >= 15) {
+        op = lz_put_length(op, literal - 15);
+    }
+    memcpy(op, anchor, literal);
+    op += literal;
+
+    return op - (unsigned char *)dest;
+}
+
+// 读取扩展长度，失败返回-1
+static int lz_get_length(const unsigned char **ip, const unsigned char *end, size_t *len) {
+    unsigned int byte;
+    do {
+        if (*ip >= end) {
+            return -1;
+        }
+        byte = *(*ip)++;
+        *len += byte;
+    } while (byte == 255);
+    return 0;
+}
+
+// 解压到dst，解压后的大小必须恰好为raw_size，成功返回0
+int log_lz_decompress(const char *source, size_t size, char *dest, size_t raw_size) {
+    const unsigned char *ip  = (const unsigned char *)source;
+    const unsigned char *end = ip + size;
+    unsigned char *op        = (unsigned char *)dest;
+    unsigned char *op_end    = op + raw_size;
+
+    while (ip < end) {
+        unsigned int token = *ip++;
+
+        size_t literal = token >> 4;
+        if (literal == 15 && lz_get_length(&ip, end, &literal) < 0) {
+            return -1;
+        }
+        if (literal > (size_t)(end - ip) || literal > (size_t)(op_end - op)) {
+            return -1;
+        }
+        memcpy(op, ip, literal);
+        op += literal;
+        ip += literal;
+
+        if (ip == end) {
+            break;
+        }
+
+        if (end - ip < 2) {
+            return -1;
+        }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+
+        size_t len = token & 15;
+        if (len == 15 && lz_get_length(&ip, end, &len) < 0) {
+            return -1;
+        }
+        len += LZ_MIN_MATCH;
+
+        if (offset == 0 || offset > (size_t)(op - (unsigned char *)dest) || len > (size_t)(op_end - op)) {
+            return -1;
+        }
+
+        // 重叠的匹配（偏移小于长度）需要逐字节复制
+        const unsigned char *match = op - offset;
+        if (offset >= len) {
+            memcpy(op, match, len);
+            op += len;
+        } else {
+            while (len--) {
+                *op++ = *match++;
+            }
+        }
+    }
+
+    return (op == op_end) ? 0 : -1;
+}
+
+// 块内记录的时间范围
+static void block_time_range(const char *data, size_t size, log_archive_block_t *block) {
+    log_record_t record;
+    size_t pos = 0;
+
+    block->min_timestamp = INT64_MAX;
+    block->max_timestamp = INT64_MIN;
+
+    while (pos < size) {
+        int ret = log_record_parse(data + pos, size - pos, 1, &record);
+        if (ret == 0) {
+            break;
+        }
+        if (ret < 0) {
+            pos += -ret;
+            continue;
+        }
+        pos += ret;
+
+        if (record.timestamp < block->min_timestamp) {
+            block->min_timestamp = record.timestamp;
+        }
+        if (record.timestamp > block->max_timestamp) {
+            block->max_timestamp = record.timestamp;
+        }
+    }
+}
+
+static int write_all(int fd, const void *data, size_t size) {
+    const char *p = data;
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n < 0) {
+            return -1;
+        }
+        p += n;
+        size -= n;
+    }
+    return 0;
+}
+
+// 将src_fd的全部内容按记录边界切分为块并逐块压缩，写入dst_path
+int log_archive_create(int src_fd, const char *dst_path) {
+    struct stat st;
+    if (fstat(src_fd, &st) < 0) {
+        return -1;
+    }
+
+    const char *data = NULL;
+    size_t size      = st.st_size;
+    if (size > 0) {
+        data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, src_fd, 0);
+        if (data == MAP_FAILED) {
+            return -1;
+        }
+        madvise((void *)data, size, MADV_SEQUENTIAL);
+    }
+
+    int ret                     = -1;
+    int fd                      = -1;
+    char *compressed            = malloc(log_lz_bound(LOG_ARCHIVE_BLOCK_MAX));
+    log_archive_block_t *blocks = malloc((size / LOG_ARCHIVE_BLOCK_SIZE + 1) * sizeof(log_archive_block_t));
+    uint32_t block_count        = 0;
+    uint64_t offset             = sizeof(log_archive_head_t);
+
+    if (!compressed || !blocks) {
+        goto cleanup;
+    }
+
+    fd = open(dst_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0 || lseek(fd, offset, SEEK_SET) < 0) {
+        goto cleanup;
+    }
+
+    for (size_t start = 0; start < size;) {
+        size_t end = size;
+        if (size - start > LOG_ARCHIVE_BLOCK_SIZE) {
+            end = log_record_sync(data, size, start + LOG_ARCHIVE_BLOCK_SIZE);
+        }
+        // 长时间找不到记录边界（无效数据）时强制切分
+        if (end - start > LOG_ARCHIVE_BLOCK_MAX) {
+            end = start + LOG_ARCHIVE_BLOCK_MAX;
+        }
+
+        log_archive_block_t *block = &blocks[block_count++];
+        block->offset              = offset;
+        block->raw_size            = end - start;
+        block_time_range(data + start, end - start, block);
+
+        // 压缩后没有变小的块原样保存
+        size_t compressed_size = log_lz_compress(data + start, end - start, compressed);
+        const char *payload    = compressed;
+        if (compressed_size >= block->raw_size) {
+            compressed_size = block->raw_size;
+            payload         = data + start;
+        }
+        block->size = compressed_size;
+
+        if (write_all(fd, payload, compressed_size) < 0) {
+            goto cleanup;
+        }
+        offset += compressed_size;
+        start = end;
+    }
+
+    // 块偏移表按8字节对齐
+    static const char padding[8] = {0};
+    size_t pad                   = (8 - offset % 8) % 8;
+    log_archive_head_t head      = {LOG_ARCHIVE_MAGIC, block_count, size, offset + pad};
+
+    if (write_all(fd, padding, pad) < 0 ||
+        write_all(fd, blocks, block_count * sizeof(log_archive_block_t)) < 0 ||
+        pwrite(fd, &head, sizeof(head), 0) != sizeof(head) ||
+        fsync(fd) < 0) {
+        goto cleanup;
+    }
+    ret = 0;
+
+cleanup:
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (ret < 0) {
+        unlink(dst_path);
+    }
+    free(compressed);
+    free(blocks);
+    if (data) {
+        munmap((void *)data, size);
+    }
+    return ret;
+}
+
+int log_archive_open(log_archive_t *archive, const char *path) {
+    struct stat st;
+    log_archive_head_t head;
+
+    archive->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (archive->fd < 0) {
+        return -1;
+    }
+
+    if (fstat(archive->fd, &st) < 0 || (size_t)st.st_size < sizeof(head)) {
+        close(archive->fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, archive->fd, 0);
+    if (map == MAP_FAILED) {
+        close(archive->fd);
+        return -1;
+    }
+
+    memcpy(&head, map, sizeof(head));
+    if (head.magic != LOG_ARCHIVE_MAGIC || head.table_offset % 8 != 0 || head.table_offset > (uint64_t)st.st_size ||
+        head.block_count > (st.st_size - head.table_offset) / sizeof(log_archive_block_t)) {
+        munmap(map, st.st_size);
+        close(archive->fd);
+        return -1;
+    }
+
+    archive->map         = map;
+    archive->map_size    = st.st_size;
+    archive->block_count = head.block_count;
+    archive->blocks      = (const log_archive_block_t *)(archive->map + head.table_offset);
+    return 0;
+}
+
+// 解压第block块到buffer（至少LOG_ARCHIVE_BLOCK_MAX字节），返回解压后的大小，失败返回-1
+int log_archive_read(const log_archive_t *archive, uint32_t block, char *buffer) {
+    if (block >= archive->block_count) {
+        return -1;
+    }
+
+    const log_archive_block_t *entry = &archive->blocks[block];
+    if (entry->raw_size > LOG_ARCHIVE_BLOCK_MAX || entry->offset > archive->map_size || entry->size > archive->map_size - entry->offset) {
+        return -1;
+    }
+
+    const char *data = archive->map + entry->offset;
+    if (entry->size == entry->raw_size) {
+        memcpy(buffer, data, entry->raw_size);
+    } else if (log_lz_decompress(data, entry->size, buffer, entry->raw_size) < 0) {
+        return -1;
+    }
+    return entry->raw_size;
+}
+
+void log_archive_close(log_archive_t *archive) {
+    munmap((void *)archive->map, archive->map_size);
+    close(archive->fd);
+}
+
+// 打开以base为当前日志文件的第n代日志，只选出可能包含[start, end]（为0表示不限）内记录的部分：
+// 普通文件通过稀疏索引确定字节范围，压缩文件根据各块的时间范围挑选块
+int log_gen_open(log_gen_t *gen, const char *base, int n, long start, long end) {
+    char path[PATH_MAX];
+    struct stat st;
+
+    memset(gen, 0, sizeof(*gen));
+    gen->fd = -1;
+    log_gen_path(base, n, path, sizeof(path));
+
+    gen->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (gen->fd >= 0) {
+        if (fstat(gen->fd, &st) < 0) {
+            close(gen->fd);
+            return -1;
+        }
+
+        // 只映射打开时的文件大小，之后追加的记录不读取
+        gen->size = st.st_size;
+        if (gen->size > 0) {
+            void *map = mmap(NULL, gen->size, PROT_READ, MAP_PRIVATE, gen->fd, 0);
+            if (map == MAP_FAILED) {
+                close(gen->fd);
+                return -1;
+            }
+            gen->map = map;
+        }
+
+        long long start_offset, end_offset;
+        log_index_range(path, n > 0, start, end, &start_offset, &end_offset);
+        gen->end   = (end_offset >= 0 && (size_t)end_offset < gen->size) ? (size_t)end_offset : gen->size;
+        gen->start = ((size_t)start_offset < gen->end) ? (size_t)start_offset : gen->end;
+
+        gen->segment_count = 1;
+        return 0;
+    }
+
+    // 已轮转的历史日志可能已被压缩
+    strncat(path, LOG_ARCHIVE_SUFFIX, sizeof(path) - strlen(path) - 1);
+    if (log_archive_open(&gen->archive, path) < 0) {
+        return -1;
+    }
+    gen->archived = 1;
+
+    gen->segments = malloc((gen->archive.block_count + 1) * sizeof(uint32_t));
+    if (!gen->segments) {
+        log_archive_close(&gen->archive);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < gen->archive.block_count; i++) {
+        const log_archive_block_t *block = &gen->archive.blocks[i];
+        if ((start > 0 && block->max_timestamp < start) || (end > 0 && block->min_timestamp > end)) {
+            continue;
+        }
+        gen->segments[gen->segment_count++] = i;
+    }
+    return 0;
+}
+
+// 取第i段；压缩文件解压到buffer（至少LOG_ARCHIVE_BLOCK_MAX字节），可在多个线程中同时调用
+int log_gen_segment(const log_gen_t *gen, int i, char *buffer, log_segment_t *segment) {
+    if (!gen->archived) {
+        segment->data  = gen->map;
+        segment->start = gen->start;
+        segment->end   = gen->end;
+        return 0;
+    }
+
+    int size = log_archive_read(&gen->archive, gen->segments[i], buffer);
+    if (size < 0) {
+        return -1;
+    }
+    segment->data  = buffer;
+    segment->start = 0;
+    segment->end   = size;
+    return 0;
+}
+
+// 未成功打开（或清零）的gen也可以关闭
+void log_gen_close(log_gen_t *gen) {
+    if (gen->archived) {
+        log_archive_close(&gen->archive);
+        free(gen->segments);
+        return;
+    }
+    if (gen->segment_count == 0) {
+        return;
+    }
+    if (gen->map) {
+        munmap((void *)gen->map, gen->size);
+    }
+    close(gen->fd);
+}
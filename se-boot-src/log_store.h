@@ -0,0 +1,71 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_LOG_STORE_H
+#define SE_BOOT_LOG_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define LOG_ARCHIVE_SUFFIX ".slz"
+#define LOG_ARCHIVE_BLOCK_SIZE (64 * 1024) // 压缩块的目标大小（解压后）
+#define LOG_ARCHIVE_BLOCK_MAX (128 * 1024) // 压缩块解压后的最大大小
+
+// 压缩后的历史日志：若干可独立解压的块，块按记录边界切分，文件末尾为块偏移表
+typedef struct log_archive_block_t {
+    uint64_t offset;
+    uint32_t size;     // 压缩后大小，与raw_size相等表示未压缩
+    uint32_t raw_size;
+    int64_t min_timestamp; // 块内记录的时间范围，用于跳过不需要的块
+    int64_t max_timestamp;
+} log_archive_block_t;
+
+typedef struct log_archive_t {
+    int fd;
+    const char *map;
+    size_t map_size;
+    uint32_t block_count;
+    const log_archive_block_t *blocks;
+} log_archive_t;
+
+// 一代日志（普通文件或压缩文件）中需要读取的部分，按顺序分为若干段
+// 普通文件只有一段，直接指向映射区；压缩文件每个块为一段，读取时解压到调用者提供的缓冲区
+typedef struct log_segment_t {
+    const char *data;
+    size_t start;
+    size_t end;
+} log_segment_t;
+
+typedef struct log_gen_t {
+    int fd; // 普通文件的fd，压缩文件为-1
+    const char *map;
+    size_t size;
+    size_t start;
+    size_t end;
+
+    int archived;
+    log_archive_t archive;
+    uint32_t *segments; // 压缩文件中需要读取的块
+    int segment_count;
+} log_gen_t;
+
+size_t log_lz_bound(size_t size);
+size_t log_lz_compress(const char *src, size_t size, char *dst);
+int log_lz_decompress(const char *src, size_t size, char *dst, size_t raw_size);
+
+int log_archive_create(int src_fd, const char *dst_path);
+int log_archive_open(log_archive_t *archive, const char *path);
+int log_archive_read(const log_archive_t *archive, uint32_t block, char *buffer);
+void log_archive_close(log_archive_t *archive);
+
+int log_gen_open(log_gen_t *gen, const char *base, int n, long start, long end);
+int log_gen_segment(const log_gen_t *gen, int i, char *buffer, log_segment_t *segment);
+void log_gen_close(log_gen_t *gen);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
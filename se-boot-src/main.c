@@ -1,84 +1,130 @@
-#include <sys/stat.h>
-#include <stdio.h>
-#include <string.h>
-#include <unistd.h>
-#include "se-boot-src/path.h"
-#include "se-boot-src/boot.h"
-#include "se-boot-src/proc.h"
-#include "se-boot-src/log.h"
-
-void help() {
-    printf("se-boot: run command as daemon or boot\n\n");
-    printf("   <command>     run command\n");
-    printf("   boot          boot script\n");
-    printf("   help          show help\n");
-    printf("   log           show the last 30 records in log\n");
-
-    // TODO
-    // printf("-------------------------\n");
-    // printf("available after <log>\n");
-    // printf("  -h, --help                  Show this help message\n");
-    // printf("  -s, --start-time TIMESTAMP  Start timestamp (milliseconds)\n");
-    // printf("  -e, --end-time TIMESTAMP    End timestamp (milliseconds)\n");
-    // printf("  -t, --type TYPE1[,TYPE2...] Include log types (comma separated)\n");
-    // printf("  -x, --exclude-type TYPE1[,TYPE2...] Exclude log types (comma separated)\n");
-    // printf("  -p, --pid PID1[,PID2...]    Include process IDs (comma separated)\n");
-    // printf("  -X, --exclude-pid PID1[,PID2...] Exclude process IDs (comma separated)\n");
-    // printf("  -P, --path PATH1[,PATH2...] Include paths (comma separated)\n");
-    // printf("  -E, --exclude-path PATH1[,PATH2...] Exclude paths (comma separated)\n");
-    // printf("  -n, --name NAME1[,NAME2...] Include names (comma separated)\n");
-    // printf("  -N, --exclude-name NAME1[,NAME2...] Exclude names (comma separated)\n");
-    // printf("  -c, --count NUM             Maximum number of log entries to return\n");
-    // printf("  -H, --human-time            Use human-readable time format\n");
-    // printf("      --no-timestamp          Do not show timestamp\n");
-    // printf("      --no-type               Do not show log type\n");
-    // printf("      --no-pid                Do not show process ID\n");
-    // printf("      --no-path               Do not show path\n");
-    // printf("      --no-name               Do not show name\n");
-    // printf("  -o, --output FILE           Output to file (default: stdout)\n");
-}
-
-int main(int argc, char **argv) {
-    if (argc == 1) {
-        help();
-        return 0;
-    }
-
-    if (argc == 2 && (strcmp(argv[1], "help") == 0 || strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0)) {
-        help();
-        return 0;
-    }
-
-    struct stat st = {0};
-    if (stat(SE_DIR, &st) == -1) {
-        mkdir(SE_DIR, 0777);
-    }
-
-    if (stat(SE_DIR, &st) == -1 || stat(SE_DIR, &st) == -1) {
-        printf("create ser_boot bad!\n");
-        return -1;
-    }
-
-    if (access(SE_LOG, F_OK) == 0 && access(SE_LOG, R_OK) < 0) {
-        perror(SE_LOG);
-        return -1;
-    }
-
-    if (access(SE_LOG_LAST, F_OK) == 0 && access(SE_LOG_LAST, R_OK) < 0) {
-        perror(SE_LOG_LAST);
-        return -1;
-    }
-
-    if (argc == 2 && (strcmp(argv[1], "boot") == 0 || strcmp(argv[1], "--boot") == 0 || strcmp(argv[1], "-b") == 0)) {
-        boot_main();
-        return 0;
-    }
-
-    if (argc >= 2 && strcmp(argv[1], "log") == 0){
-        log_read_main(argc, argv);
-        return 0;
-    }
-
-    create_daemon((const char **)argv);
-    return 0;
+#include <sys/stat.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "se-boot-src/path.h"
+#include "se-boot-src/boot.h"
+#include "se-boot-src/proc.h"
+#include "se-boot-src/log.h"
+#include "se-boot-src/service_ctl.h"
+
+void help() {
+    printf("se-boot: run command as daemon or boot\n\n");
+    printf("   [--key=value ...] <command>   run command\n");
+    printf("   boot          boot script\n");
+    printf("   help          show help\n");
+    printf("   log           show the last 30 records in log\n");
+    printf("   status [name|path|pid ...]   show services\n");
+    printf("   stop <name|path|pid ...>     stop services (no restart)\n");
+    printf("   restart <name|path|pid ...>  restart services now\n");
+    printf("\noptions before <command>:\n");
+    printf("   --restart=never|on-failure|always   restart policy (default never)\n");
+    printf("   --restart_delay=100ms               first backoff, doubled on each quick exit\n");
+    printf("   --restart_max_delay=30s             backoff limit\n");
+    printf("   --restart_burst=5                   give up after this many restarts within restart_window\n");
+    printf("   --restart_window=60s\n");
+    printf("   --zygote                            pre-fork the replacement child\n");
+    printf("   --pty                               capture stdout through a pseudo-terminal (line buffered)\n");
+    printf("   --cpu_max=50%%|quota/period|max     cgroup v2 limits, each run in its own leaf under SE_CGROUP_ROOT\n");
+    printf("   --cpu_weight=N  --io_weight=N\n");
+    printf("   --memory_max=512M  --memory_high=256M  --pids_max=N\n");
+    printf("   --cgroup                            own cgroup without limits (for exit stats)\n");
+    printf("   --cpus=0-3,8                        CPU affinity\n");
+    printf("   --numa_node=0                       run on the CPUs of these NUMA nodes\n");
+    printf("   --sched=other|batch|idle|fifo:N|rr:N scheduling policy\n");
+    printf("   --nice=N  --ioprio=rt:N|be:N|idle\n");
+    printf("\noptions after <log>:\n");
+    printf("   -f, --follow                  keep printing new records as they are written\n");
+    printf("   -j, --jobs N                  scan with N threads when --count is negative\n");
+    printf("   --stats                       print counts/bytes per name, pid and type instead of records\n");
+    printf("   --bucket 1s|1m|1h             with --stats, also print a per-bucket histogram\n");
+
+    // TODO
+    // printf("-------------------------\n");
+    // printf("available after <log>\n");
+    // printf("  -h, --help                  Show this help message\n");
+    // printf("  -s, --start-time TIMESTAMP  Start timestamp (milliseconds)\n");
+    // printf("  -e, --end-time TIMESTAMP    End timestamp (milliseconds)\n");
+    // printf("  -t, --type TYPE1[,TYPE2...] Include log types (comma separated)\n");
+    // printf("  -x, --exclude-type TYPE1[,TYPE2...] Exclude log types (comma separated)\n");
+    // printf("  -p, --pid PID1[,PID2...]    Include process IDs (comma separated)\n");
+    // printf("  -X, --exclude-pid PID1[,PID2...] Exclude process IDs (comma separated)\n");
+    // printf("  -P, --path PATH1[,PATH2...] Include paths (comma separated)\n");
+    // printf("  -E, --exclude-path PATH1[,PATH2...] Exclude paths (comma separated)\n");
+    // printf("  -n, --name NAME1[,NAME2...] Include names (comma separated)\n");
+    // printf("  -N, --exclude-name NAME1[,NAME2...] Exclude names (comma separated)\n");
+    // printf("  -c, --count NUM             Maximum number of log entries to return\n");
+    // printf("  -H, --human-time            Use human-readable time format\n");
+    // printf("      --no-timestamp          Do not show timestamp\n");
+    // printf("      --no-type               Do not show log type\n");
+    // printf("      --no-pid                Do not show process ID\n");
+    // printf("      --no-path               Do not show path\n");
+    // printf("      --no-name               Do not show name\n");
+    // printf("  -o, --output FILE           Output to file (default: stdout)\n");
+}
+
+int main(int argc, char **argv) {
+    if (argc == 1) {
+        help();
+        return 0;
+    }
+
+    if (argc == 2 && (strcmp(argv[1], "help") == 0 || strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0)) {
+        help();
+        return 0;
+    }
+
+    struct stat st = {0};
+    if (stat(SE_DIR, &st) == -1) {
+        mkdir(SE_DIR, 0777);
+    }
+
+    if (stat(SE_DIR, &st) == -1 || stat(SE_DIR, &st) == -1) {
+        printf("create ser_boot bad!\n");
+        return -1;
+    }
+
+    if (access(SE_LOG, F_OK) == 0 && access(SE_LOG, R_OK) < 0) {
+        perror(SE_LOG);
+        return -1;
+    }
+
+    if (argc == 2 && (strcmp(argv[1], "boot") == 0 || strcmp(argv[1], "--boot") == 0 || strcmp(argv[1], "-b") == 0)) {
+        boot_main();
+        return 0;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "log") == 0){
+        log_read_main(argc, argv);
+        return 0;
+    }
+
+    if (argc >= 2 && (strcmp(argv[1], "status") == 0 || strcmp(argv[1], "stop") == 0 || strcmp(argv[1], "restart") == 0)) {
+        return (service_ctl_main(argc, argv) < 0) ? 1 : 0;
+    }
+
+    // <command>之前的--key=value为启动选项，"--"之后的参数都属于命令
+    service_opt_t opt;
+    service_opt_init(&opt);
+
+    int first = 1;
+    while (first < argc && strncmp(argv[first], "--", 2) == 0) {
+        if (strcmp(argv[first], "--") == 0) {
+            first++;
+            break;
+        }
+        if (service_opt_parse(&opt, argv[first] + 2) < 0) {
+            printf("invalid option: %s\n", argv[first]);
+            return -1;
+        }
+        first++;
+    }
+
+    if (first >= argc) {
+        help();
+        return 0;
+    }
+
+    create_daemon((const char **)(argv + first - 1), &opt);
+    return 0;
 }
\ No newline at end of file
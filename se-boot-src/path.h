@@ -1,21 +1,30 @@
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-#ifndef _SE_BOOT_PATH_H
-#define _SE_BOOT_PATH_H
-
-#define SE_DIR "/var/se_boot"
-#define SE_PID_FILE "/var/se_boot/se_boot.pid"
-#define SE_LOCK "/var/se_boot/se_boot.lock"
-#define SE_LOG "/var/se_boot/se_boot.log"
-#define SE_LOG_LAST "/var/se_boot/se_boot_last.log"
-#define SCRIPT_DIR "/etc/se_boot/"
-
-#endif
-
-#ifdef __cplusplus
-}
-#endif
-
-
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef _SE_BOOT_PATH_H
+#define _SE_BOOT_PATH_H
+
+// 可在编译时通过 -DSE_DIR=... 重定向（例如基准测试）
+#ifndef SE_DIR
+#define SE_DIR "/var/se_boot"
+#endif
+
+#define SE_PID_FILE SE_DIR "/se_boot.pid"
+#define SE_LOCK SE_DIR "/se_boot.lock"
+#define SE_LOG SE_DIR "/se_boot.log"
+#define SE_LOG_INDEX SE_LOG ".idx"
+#define SE_LOG_SOCK SE_DIR "/se_boot.sock"
+#define SE_LOG_RING SE_DIR "/se_boot.ring"
+#define SE_LOG_SHARD_DIR SE_DIR "/shards" // 按服务分片的日志文件
+#define SE_CTL_SOCK SE_DIR "/se_boot.ctl" // 监管进程接收启动请求的控制套接字
+#define SE_SERVICE_TABLE SE_DIR "/se_boot.services" // 服务表，供se-boot status/stop/restart查询
+#define SCRIPT_DIR "/etc/se_boot/"
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+
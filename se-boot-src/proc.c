@@ -1,161 +1,559 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <sys/types.h>
-#include <sys/wait.h>
-#include <sys/stat.h>
-#include <string.h>
-#include <libgen.h>
-#include <errno.h>
-#include "se-boot-src/proc.h"
-#include "se-boot-src/log.h"
-
-// 创建守护进程
-int daemonize() {
-    pid_t pid = fork();
-    if (pid < 0) {
-        return -1;
-    } else if (pid > 0) {
-        exit(0); // 父进程退出
-    }
-
-    // 子进程继续
-    // 创建新的会话
-    if (setsid() < 0){
-        return -1;
-    }
-
-    pid = fork();
-    if (pid < 0) {
-        return -1;
-    } else if (pid > 0) {
-        exit(0); // 第二个父进程退出
-    }
-
-    return 0;
-}
-
-pid_t process_run(const char **argv){
-
-    char *argv_clone = strdup(argv[1]);
-    if (argv_clone == NULL){
-        return -1;
-    }
-
-    char *base_name  = basename(argv_clone);
-    char msg[256];
-    umask(0);
-    for (int i = 0; i < sysconf(_SC_OPEN_MAX); i++) {
-        close(i);
-    }
-
-    int pipe_a[2]; // 用于输入到子进程
-    int pipe_b[2]; // 用于从子进程输出
-
-    if (pipe(pipe_a) < 0 || pipe(pipe_b) < 0) {
-        log_write(LOG_TYPE_PROCESS, getpid(), argv[1], base_name, strerror(errno));
-        free(argv_clone);
-        return -1;
-    }
-
-    pid_t pid = fork();
-    if (pid < 0) {
-        log_write(LOG_TYPE_PROCESS, getpid(), argv[1], base_name, strerror(errno));
-        free(argv_clone);
-        return -2;
-    } else if (pid == 0) {
-        // 子进程
-        close(pipe_a[1]); // 关闭写端
-        close(pipe_b[0]); // 关闭读端
-
-        // 重定向标准输入输出
-        dup2(pipe_a[0], STDIN_FILENO);
-        dup2(pipe_b[1], STDOUT_FILENO);
-        dup2(pipe_b[1], STDERR_FILENO);
-        
-        // 执行新进程
-        execvp(argv[1], (char **)(argv + 1));
-        log_write(LOG_TYPE_PROCESS, getpid(), argv[1], base_name, strerror(errno));
-
-        free(argv_clone);
-        exit(1); // 如果execv失败
-        return -3;
-    } else {
-        // 父进程（守护进程）
-        close(pipe_a[0]); // 关闭读端
-        close(pipe_b[1]); // 关闭写端
-
-        char buffer[1024];
-        ssize_t bytes_read;
-        
-
-        log_write(LOG_TYPE_PROCESS, pid, argv[1], base_name, "start!");
-
-        // while ((bytes_read = read(pipe_b[0], buffer, sizeof(buffer) - 1)) > 0) {
-        //     buffer[bytes_read] = '\0';
-        //     log_write(LOG_TYPE_PROCESS, pid, argv[1], base_name, buffer);
-        // }
-
-        while ((bytes_read = read(pipe_b[0], buffer, sizeof(buffer) - 1)) > 0) {
-            buffer[bytes_read] = '\0';
-
-            char *line = buffer;
-            char *next;
-
-            while (next = strchr(line, '\r')) {
-                *next = ' ';
-                line  = next + 1;
-            }
-
-            line = buffer;
-
-            do {
-                next = strchr(line, '\n');
-                if (next)
-                    *next = '\0';
-                if (*line != '\0'){
-                    log_write(LOG_TYPE_PROCESS, pid, argv[1], base_name, line);
-                }
-                line = next + 1;
-            } while (next);
-        }
-
-        // 等待子进程结束
-        int status;
-        waitpid(pid, &status, 0);
-
-        close(pipe_a[1]);
-        close(pipe_b[0]);
-
-
-        log_write(LOG_TYPE_PROCESS, pid, argv[1], base_name, "exit!");
-        free(argv_clone);
-        return pid;
-    }
-}
-
-pid_t create_daemon(const char **argv) {
-
-    char *filename = strdup(argv[1]);
-    if (!filename){
-        return -1;
-    }
-
-    // 创建守护进程
-    if (daemonize() < 0) {
-        char msg[256];
-        snprintf(msg, sizeof(msg), "daemonize failed!: %s", strerror(errno));
-        log_write(LOG_TYPE_PROCESS, getpid(), argv[1], basename(filename), msg);
-        free(filename);
-        return -1;
-    }
-
-
-    free(filename);
-    return process_run(argv);
-
-
-}
-
-int process_exists(pid_t pid) {
-    return (kill(pid, 0) == 0);
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <string.h>
+#include <libgen.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <spawn.h>
+#include <time.h>
+#include "se-boot-src/proc.h"
+#include "se-boot-src/log.h"
+#include "se-boot-src/capture.h"
+#include "se-boot-src/cgroup.h"
+#include "se-boot-src/supervisor.h"
+#include "se-boot-src/service_table.h"
+
+// 创建守护进程
+int daemonize() {
+    pid_t pid = fork();
+    if (pid < 0) {
+        return -1;
+    } else if (pid > 0) {
+        exit(0); // 父进程退出
+    }
+
+    // 子进程继续
+    // 创建新的会话
+    if (setsid() < 0){
+        return -1;
+    }
+
+    pid = fork();
+    if (pid < 0) {
+        return -1;
+    } else if (pid > 0) {
+        exit(0); // 第二个父进程退出
+    }
+
+    return 0;
+}
+
+// 关闭所有不小于from的fd。优先使用close_range，内核不支持时遍历/proc/self/fd只关闭实际打开的fd，
+// 避免nofile很大时逐个close；只使用系统调用，可在vfork出的子进程中调用
+void close_fds(int from) {
+#ifdef SYS_close_range
+    if (syscall(SYS_close_range, from, ~0U, 0) == 0) {
+        return;
+    }
+#endif
+
+    int dir_fd = open("/proc/self/fd", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0) {
+        for (long fd = from; fd < sysconf(_SC_OPEN_MAX); fd++) {
+            close(fd);
+        }
+        return;
+    }
+
+    char buffer[4096];
+    long size;
+    while ((size = syscall(SYS_getdents64, dir_fd, buffer, sizeof(buffer))) > 0) {
+        for (long pos = 0; pos < size;) {
+            struct dirent64 *entry = (struct dirent64 *)(buffer + pos);
+            pos += entry->d_reclen;
+
+            int fd = 0;
+            const char *p = entry->d_name;
+            if (*p < '0' || *p > '9') {
+                continue;
+            }
+            while (*p >= '0' && *p <= '9') {
+                fd = fd * 10 + (*p++ - '0');
+            }
+            if (fd >= from && fd != dir_fd) {
+                close(fd);
+            }
+        }
+    }
+    close(dir_fd);
+}
+
+// 一个子进程及其管道在本进程中的一端
+typedef struct process_child_t {
+    pid_t pid;
+    int stdin_fd; // stdin管道的写端，与原先一致保持打开直到子进程退出；伪终端模式下为-1
+    int out_fd;
+    int err_fd;
+    int go_fd; // 预先fork的子进程（zygote）等待的管道，写入一个字节后exec；已exec的子进程为-1
+    cgroup_t cgroup;
+} process_child_t;
+
+static long process_now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static double timeval_ms(const struct timeval *tv) {
+    return tv->tv_sec * 1000.0 + tv->tv_usec / 1000.0;
+}
+
+// 格式化退出记录中的退出原因与wait4得到的资源用量，以空格开头：
+// " code=N"或" signal=N[ core=1]"，之后为wall_ms/utime_ms/stime_ms/maxrss_kb/nvcsw/nivcsw/inblock/oublock
+size_t process_exit_stats(int status, long wall_us, const struct rusage *usage, char *buffer, size_t size) {
+    size_t len;
+    if (WIFSIGNALED(status)) {
+        len = snprintf(buffer, size, WCOREDUMP(status) ? " signal=%d core=1" : " signal=%d", WTERMSIG(status));
+    } else {
+        len = snprintf(buffer, size, " code=%d", WEXITSTATUS(status));
+    }
+
+    if (len < size) {
+        len += snprintf(buffer + len, size - len,
+                        " wall_ms=%.3f utime_ms=%.3f stime_ms=%.3f maxrss_kb=%ld nvcsw=%ld nivcsw=%ld inblock=%ld oublock=%ld",
+                        wall_us / 1000.0, timeval_ms(&usage->ru_utime), timeval_ms(&usage->ru_stime), usage->ru_maxrss,
+                        usage->ru_nvcsw, usage->ru_nivcsw, usage->ru_inblock, usage->ru_oublock);
+    }
+    return (len < size) ? len : size - 1;
+}
+
+// 把fd移到标准输入输出之外，保证dup2到0/1/2时不会覆盖其他待复制的fd
+static int fd_above_stdio(int fd) {
+    if (fd > STDERR_FILENO) {
+        return fd;
+    }
+    int moved = fcntl(fd, F_DUPFD_CLOEXEC, STDERR_FILENO + 1);
+    close(fd);
+    return moved;
+}
+
+// 创建count个管道（pipes[i][0]为读端），均为CLOEXEC且不占用0/1/2
+int process_pipes(int pipes[][2], int count) {
+    for (int i = 0; i < count; i++) {
+        if (pipe2(pipes[i], O_CLOEXEC) < 0) {
+            for (int j = 0; j < i; j++) {
+                close(pipes[j][0]);
+                close(pipes[j][1]);
+            }
+            return -1;
+        }
+        pipes[i][0] = fd_above_stdio(pipes[i][0]);
+        pipes[i][1] = fd_above_stdio(pipes[i][1]);
+    }
+    return 0;
+}
+
+// 创建子进程的stdin/stdout/stderr及其后的count-3个管道，与process_pipes的约定相同：
+// pipes[0][0]、pipes[1][1]、pipes[2][1]交给子进程。pty非0时stdin/stdout使用同一个伪终端的从端，
+// pipes[1][0]为主端，pipes[0][1]为-1；stderr仍为管道，保持与stdout区分
+int process_stdio(int pipes[][2], int count, int pty) {
+    if (!pty) {
+        return process_pipes(pipes, count);
+    }
+
+    if (process_pipes(pipes + 2, count - 2) < 0) {
+        return -1;
+    }
+
+    int master;
+    int slave;
+    if (capture_pty(&master, &slave) < 0) {
+        int err = errno;
+        for (int i = 2; i < count; i++) {
+            close(pipes[i][0]);
+            close(pipes[i][1]);
+        }
+        errno = err;
+        return -1;
+    }
+
+    pipes[0][0] = fd_above_stdio(slave);
+    pipes[0][1] = -1;
+    pipes[1][0] = fd_above_stdio(master);
+    pipes[1][1] = fcntl(pipes[0][0], F_DUPFD_CLOEXEC, STDERR_FILENO + 1);
+    return 0;
+}
+
+// 在fork出的子进程中完成exec前的设置并exec，只在失败时返回（errno为原因）
+static void process_exec(const char **argv, const service_opt_t *opt, int pipes[][2], const process_child_t *child) {
+    setpgid(0, 0);
+    if (cgroup_enter(&child->cgroup) < 0 || sched_policy_apply(&opt->sched) < 0) {
+        return;
+    }
+    if (dup2(pipes[0][0], STDIN_FILENO) < 0 || dup2(pipes[1][1], STDOUT_FILENO) < 0 || dup2(pipes[2][1], STDERR_FILENO) < 0) {
+        return;
+    }
+    execvp(argv[1], (char **)(argv + 1));
+}
+
+// 子进程在exec前需要额外设置（加入cgroup、调度参数）时使用fork，exec失败的errno通过CLOEXEC管道传回。
+// 代替在命令前加taskset/chrt/ionice，省去一次exec
+static int process_fork(const char **argv, const service_opt_t *opt, process_child_t *child) {
+    int pipes[4][2]; // stdin/stdout/stderr/errno
+    if (process_stdio(pipes, 4, opt->pty) < 0) {
+        return errno;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        process_exec(argv, opt, pipes, child);
+        int err = errno;
+        write(pipes[3][1], &err, sizeof(err));
+        _exit(127);
+    }
+
+    int err = (pid < 0) ? errno : 0;
+    close(pipes[0][0]);
+    close(pipes[1][1]);
+    close(pipes[2][1]);
+    close(pipes[3][1]);
+
+    // exec成功时管道随之关闭，读到EOF
+    if (pid > 0) {
+        while (read(pipes[3][0], &err, sizeof(err)) < 0 && errno == EINTR) {
+        }
+        if (err != 0) {
+            waitpid(pid, NULL, 0);
+        }
+    }
+    close(pipes[3][0]);
+
+    if (err != 0) {
+        if (pipes[0][1] >= 0) {
+            close(pipes[0][1]);
+        }
+        close(pipes[1][0]);
+        close(pipes[2][0]);
+        return err;
+    }
+
+    child->pid      = pid;
+    child->stdin_fd = pipes[0][1];
+    child->out_fd   = pipes[1][0];
+    child->err_fd   = pipes[2][0];
+    child->go_fd    = -1;
+    return 0;
+}
+
+// 启动子进程，成功返回0，失败返回errno
+static int process_spawn(const char **argv, const service_opt_t *opt, process_child_t *child) {
+    if (child->cgroup.procs_fd >= 0 || sched_policy_used(&opt->sched)) {
+        return process_fork(argv, opt, child);
+    }
+
+    int pipes[3][2]; // 子进程的stdin/stdout/stderr
+
+    // 子进程只通过posix_spawn的dup2得到需要的一端，其余随exec关闭
+    if (process_stdio(pipes, 3, opt->pty) < 0) {
+        return errno;
+    }
+
+    // posix_spawn以vfork方式创建子进程，不复制本进程的页表；exec失败时直接返回错误码
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, pipes[0][0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, pipes[1][1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, pipes[2][1], STDERR_FILENO);
+
+    // 子进程位于独立的进程组，se-boot stop可以连同其启动的进程一起终止
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+    posix_spawnattr_setpgroup(&attr, 0);
+
+    int err = posix_spawnp(&child->pid, argv[1], &actions, &attr, (char **)(argv + 1), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+
+    close(pipes[0][0]);
+    close(pipes[1][1]);
+    close(pipes[2][1]);
+
+    if (err != 0) {
+        if (pipes[0][1] >= 0) {
+            close(pipes[0][1]);
+        }
+        close(pipes[1][0]);
+        close(pipes[2][0]);
+        return err;
+    }
+
+    child->stdin_fd = pipes[0][1];
+    child->out_fd   = pipes[1][0];
+    child->err_fd   = pipes[2][0];
+    child->go_fd    = -1;
+    return 0;
+}
+
+// 为一次运行准备cgroup后启动子进程，成功返回0，失败返回errno
+static int process_start(const char **argv, const char *base_name, const service_opt_t *opt, process_child_t *child) {
+    char msg[PATH_MAX + 64];
+    if (cgroup_create(&child->cgroup, &opt->cgroup, base_name, msg, sizeof(msg)) < 0 || msg[0]) {
+        log_write(LOG_TYPE_PROCESS, getpid(), argv[1], base_name, msg);
+    }
+
+    int err = process_spawn(argv, opt, child);
+    if (err != 0) {
+        cgroup_destroy(&child->cgroup);
+    }
+    return err;
+}
+
+// 预先fork下一个子进程：管道与cgroup已准备好，阻塞等待go管道，收到一个字节后立即exec，go管道关闭时退出
+static int zygote_fork(const char **argv, const char *base_name, const service_opt_t *opt, process_child_t *zygote) {
+    char msg[PATH_MAX + 64];
+    if (cgroup_create(&zygote->cgroup, &opt->cgroup, base_name, msg, sizeof(msg)) < 0 || msg[0]) {
+        log_write(LOG_TYPE_PROCESS, getpid(), argv[1], base_name, msg);
+    }
+
+    int pipes[4][2]; // stdin/stdout/stderr/go
+    if (process_stdio(pipes, 4, opt->pty) < 0) {
+        cgroup_destroy(&zygote->cgroup);
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(pipes[3][1]);
+
+        char c;
+        ssize_t n;
+        do {
+            n = read(pipes[3][0], &c, 1);
+        } while (n < 0 && errno == EINTR);
+        if (n != 1) {
+            _exit(0);
+        }
+
+        process_exec(argv, opt, pipes, zygote);
+        log_write(LOG_TYPE_PROCESS, getpid(), argv[1], base_name, strerror(errno));
+        _exit(127);
+    }
+
+    int err = errno;
+    close(pipes[0][0]);
+    close(pipes[1][1]);
+    close(pipes[2][1]);
+    close(pipes[3][0]);
+
+    if (pid < 0) {
+        if (pipes[0][1] >= 0) {
+            close(pipes[0][1]);
+        }
+        close(pipes[1][0]);
+        close(pipes[2][0]);
+        close(pipes[3][1]);
+        cgroup_destroy(&zygote->cgroup);
+        errno = err;
+        return -1;
+    }
+
+    zygote->pid      = pid;
+    zygote->stdin_fd = pipes[0][1];
+    zygote->out_fd   = pipes[1][0];
+    zygote->err_fd   = pipes[2][0];
+    zygote->go_fd    = pipes[3][1];
+    return 0;
+}
+
+// 放弃预先fork的子进程：关闭go管道使其退出
+static void zygote_cancel(process_child_t *zygote) {
+    close(zygote->go_fd);
+    if (zygote->stdin_fd >= 0) {
+        close(zygote->stdin_fd);
+    }
+    close(zygote->out_fd);
+    close(zygote->err_fd);
+    waitpid(zygote->pid, NULL, 0);
+    cgroup_destroy(&zygote->cgroup);
+    zygote->pid = -1;
+}
+
+// 作为监视进程运行一个程序：捕获其输出直到退出，并按opt中的重启策略重启
+pid_t process_run(const char **argv, const service_opt_t *opt){
+
+    char *argv_clone = strdup(argv[1]);
+    if (argv_clone == NULL){
+        return -1;
+    }
+
+    char *base_name  = basename(argv_clone);
+    char msg[512];
+    umask(0);
+    close_fds(0);
+    log_reset();
+
+    process_child_t child;
+    process_child_t zygote = {.pid = -1};
+    service_restart_t restart = {0};
+
+    int err = process_start(argv, base_name, opt, &child);
+    if (err != 0) {
+        log_write(LOG_TYPE_PROCESS, getpid(), argv[1], base_name, strerror(err));
+        free(argv_clone);
+        return -2;
+    }
+    long start    = service_now();
+    long start_us = process_now_us();
+
+    // 在服务表中登记，供se-boot status/stop/restart使用；服务表不可用时entry为NULL，不影响运行
+    service_entry_t *entry = service_table_claim(argv[1], base_name);
+    service_table_set(entry, SERVICE_STATE_RUNNING, child.pid, 0, 0);
+
+    int status = 0;
+    int state  = SERVICE_STATE_EXITED;
+    while (1) {
+        log_write(LOG_TYPE_PROCESS, child.pid, argv[1], base_name, "start!");
+
+        // 重启时只需唤醒已经fork好的子进程
+        if (opt->zygote && opt->restart != SERVICE_RESTART_NEVER && zygote.pid < 0 && zygote_fork(argv, base_name, opt, &zygote) < 0) {
+            log_write(LOG_TYPE_PROCESS, getpid(), argv[1], base_name, strerror(errno));
+        }
+
+        // 持有日志fd直到子进程退出，stdout/stderr分别按行重组后写入，每次read得到的完整行合并为一次writev
+        capture_t capture;
+        if (capture_open(&capture, child.pid, argv[1], base_name, child.out_fd, child.err_fd, opt->pty) < 0) {
+            log_write(LOG_TYPE_PROCESS, child.pid, argv[1], base_name, "no memory!");
+            close(child.out_fd);
+            close(child.err_fd);
+        } else {
+            if (capture_run(&capture) < 0) {
+                log_write(LOG_TYPE_PROCESS, child.pid, argv[1], base_name, strerror(errno));
+            }
+            capture_close(&capture);
+        }
+
+        // 等待子进程结束，同时取得其（含已回收的后代）资源用量
+        struct rusage usage;
+        int waited;
+        while ((waited = wait4(child.pid, &status, 0, &usage)) < 0 && errno == EINTR) {
+        }
+        int wait_err = errno;
+        long exit_us = process_now_us();
+        long ran     = service_now() - start;
+
+        if (child.stdin_fd >= 0) {
+            close(child.stdin_fd);
+        }
+
+        // 无法取得退出状态（例如子进程已被其他方式回收）时不写退出记录，也不按重启策略重启
+        if (waited < 0) {
+            log_write(LOG_TYPE_PROCESS, child.pid, argv[1], base_name, strerror(wait_err));
+            cgroup_destroy(&child.cgroup);
+            status = 0;
+            break;
+        }
+
+        // 退出记录：退出码或信号、耗时与资源用量；使用cgroup时再附上本次运行的memory.peak与cpu.stat
+        char exit_stats[192];
+        char stats[256];
+        process_exit_stats(status, exit_us - start_us, &usage, exit_stats, sizeof(exit_stats));
+        cgroup_stats(&child.cgroup, stats, sizeof(stats));
+        cgroup_destroy(&child.cgroup);
+        snprintf(msg, sizeof(msg), "exit!%s%s", exit_stats, stats);
+        log_write(LOG_TYPE_PROCESS, child.pid, argv[1], base_name, msg);
+
+        // se-boot stop/restart的请求优先于重启策略
+        long delay;
+        int request = service_table_request(entry);
+        if (request == SERVICE_REQUEST_STOP) {
+            log_write(LOG_TYPE_PROCESS, child.pid, argv[1], base_name, "stopped!");
+            state = SERVICE_STATE_STOPPED;
+            break;
+        }
+        if (request == SERVICE_REQUEST_RESTART) {
+            restart.count++;
+            delay = 0;
+            log_write(LOG_TYPE_PROCESS, child.pid, argv[1], base_name, "restart requested");
+        } else {
+            delay = service_restart_next(opt, &restart, status, ran, msg, sizeof(msg));
+            if (msg[0]) {
+                log_write(LOG_TYPE_PROCESS, child.pid, argv[1], base_name, msg);
+            }
+            if (delay < 0) {
+                break;
+            }
+        }
+
+        service_table_set(entry, SERVICE_STATE_BACKOFF, child.pid, restart.count, status);
+        request = service_table_wait(entry, delay);
+        if (request == SERVICE_REQUEST_STOP) {
+            log_write(LOG_TYPE_PROCESS, child.pid, argv[1], base_name, "stopped!");
+            state = SERVICE_STATE_STOPPED;
+            break;
+        }
+
+        err = 0;
+        if (zygote.pid > 0) {
+            if (write(zygote.go_fd, "", 1) == 1) {
+                close(zygote.go_fd);
+                child      = zygote;
+                zygote.pid = -1;
+            } else {
+                zygote_cancel(&zygote);
+                err = process_start(argv, base_name, opt, &child);
+            }
+        } else {
+            err = process_start(argv, base_name, opt, &child);
+        }
+        if (err != 0) {
+            log_write(LOG_TYPE_PROCESS, getpid(), argv[1], base_name, strerror(err));
+            break;
+        }
+        start    = service_now();
+        start_us = process_now_us();
+        service_table_set(entry, SERVICE_STATE_RUNNING, child.pid, restart.count, 0);
+
+        // 从发现退出到新的子进程开始运行的耗时，含退避等待
+        snprintf(msg, sizeof(msg), "restart #%d: recovered in %.3f ms (backoff %ld ms)", restart.count,
+                 (process_now_us() - exit_us) / 1000.0, delay);
+        log_write(LOG_TYPE_PROCESS, child.pid, argv[1], base_name, msg);
+    }
+
+    service_table_release(entry, state, status);
+
+    if (zygote.pid > 0) {
+        zygote_cancel(&zygote);
+    }
+
+    free(argv_clone);
+    return child.pid;
+}
+
+pid_t create_daemon(const char **argv, const service_opt_t *opt) {
+
+    // 启用监管模式时交由监管进程启动并持有，本进程立即返回
+    if (supervisor_request(argv + 1, opt) >= 0) {
+        return 0;
+    }
+
+    char *filename = strdup(argv[1]);
+    if (!filename){
+        return -1;
+    }
+
+    // 创建守护进程
+    if (daemonize() < 0) {
+        char msg[256];
+        snprintf(msg, sizeof(msg), "daemonize failed!: %s", strerror(errno));
+        log_write(LOG_TYPE_PROCESS, getpid(), argv[1], basename(filename), msg);
+        free(filename);
+        return -1;
+    }
+
+
+    free(filename);
+    return process_run(argv, opt);
+
+
+}
+
+int process_exists(pid_t pid) {
+    return (kill(pid, 0) == 0);
 }
\ No newline at end of file
@@ -1,18 +1,24 @@
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-#ifndef SE_BOOT_PROC_H
-#define SE_BOOT_PROC_H
-
-#include <unistd.h>
-
-int process_run(const char **argv);
-pid_t create_daemon(const char **argv);
-int process_exists(pid_t pid);
-int daemonize();
-#endif
-
-#ifdef __cplusplus
-}
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_PROC_H
+#define SE_BOOT_PROC_H
+
+#include <unistd.h>
+#include <sys/resource.h>
+#include "se-boot-src/service.h"
+
+void close_fds(int from);
+int process_pipes(int pipes[][2], int count);
+int process_stdio(int pipes[][2], int count, int pty);
+size_t process_exit_stats(int status, long wall_us, const struct rusage *usage, char *buffer, size_t size);
+int process_run(const char **argv, const service_opt_t *opt);
+pid_t create_daemon(const char **argv, const service_opt_t *opt);
+int process_exists(pid_t pid);
+int daemonize();
+#endif
+
+#ifdef __cplusplus
+}
 #endif
\ No newline at end of file
@@ -0,0 +1,274 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include "se-boot-src/sched_policy.h"
+
+// 与<linux/ioprio.h>一致
+#define SCHED_IOPRIO_CLASS_SHIFT (13)
+#define SCHED_IOPRIO_WHO_PROCESS (1)
+#define SCHED_IOPRIO_VALUE(class, data) (((class) << SCHED_IOPRIO_CLASS_SHIFT) | (data))
+
+#define SCHED_NODE_CPULIST "/sys/devices/system/node/node%d/cpulist"
+
+static const struct {
+    const char *name;
+    int policy;
+} sched_policies[] = {
+    {"other", SCHED_OTHER},
+    {"batch", SCHED_BATCH},
+    {"idle", SCHED_IDLE},
+    {"fifo", SCHED_FIFO},
+    {"rr", SCHED_RR},
+};
+
+// I/O调度类，下标即ioprio的class
+static const char *ioprio_classes[] = {"none", "rt", "be", "idle"};
+
+void sched_policy_init(sched_policy_t *sched) {
+    memset(sched, 0, sizeof(sched_policy_t));
+    sched->policy = -1;
+    sched->ioprio = -1;
+}
+
+// 解析"0-3,8,10-11"格式的列表（与/sys中的cpulist、taskset -c相同）
+static int parse_list(const char *text, cpu_set_t *set) {
+    CPU_ZERO(set);
+    const char *p = text;
+    while (*p) {
+        char *end;
+        long first = strtol(p, &end, 10);
+        long last  = first;
+        if (end == p || first < 0) {
+            return -1;
+        }
+        if (*end == '-') {
+            p    = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p || last < first) {
+                return -1;
+            }
+        }
+        if (last >= CPU_SETSIZE) {
+            return -1;
+        }
+        for (long i = first; i <= last; i++) {
+            CPU_SET(i, set);
+        }
+
+        if (*end == ',') {
+            end++;
+        } else if (*end != '\0' && *end != '\n') {
+            return -1;
+        }
+        p = end;
+        if (*p == '\n') {
+            break;
+        }
+    }
+    return CPU_COUNT(set) > 0 ? 0 : -1;
+}
+
+// 将NUMA节点列表换算为这些节点上的CPU
+static int parse_nodes(const char *text, cpu_set_t *cpus) {
+    cpu_set_t nodes;
+    if (parse_list(text, &nodes) < 0) {
+        return -1;
+    }
+
+    CPU_ZERO(cpus);
+    for (int node = 0; node < CPU_SETSIZE; node++) {
+        if (!CPU_ISSET(node, &nodes)) {
+            continue;
+        }
+
+        char path[64];
+        char buffer[1024];
+        snprintf(path, sizeof(path), SCHED_NODE_CPULIST, node);
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return -1;
+        }
+        ssize_t len = read(fd, buffer, sizeof(buffer) - 1);
+        close(fd);
+        if (len <= 0) {
+            return -1;
+        }
+        buffer[len] = '\0';
+
+        // 没有CPU的节点（只有内存）cpulist为空行，跳过
+        cpu_set_t node_cpus;
+        if (buffer[0] != '\n' && parse_list(buffer, &node_cpus) == 0) {
+            CPU_OR(cpus, cpus, &node_cpus);
+        }
+    }
+    return CPU_COUNT(cpus) > 0 ? 0 : -1;
+}
+
+// sched=<策略>[:<优先级>]，与chrt一致fifo/rr的优先级为1-99，其他策略为0
+static int parse_sched(sched_policy_t *sched, const char *value) {
+    const char *colon = strchr(value, ':');
+    size_t len        = colon ? (size_t)(colon - value) : strlen(value);
+
+    long priority = 0;
+    if (colon) {
+        char *end;
+        priority = strtol(colon + 1, &end, 10);
+        if (end == colon + 1 || *end) {
+            return -1;
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(sched_policies) / sizeof(sched_policies[0]); i++) {
+        if (strlen(sched_policies[i].name) != len || strncmp(value, sched_policies[i].name, len) != 0) {
+            continue;
+        }
+        int realtime = sched_policies[i].policy == SCHED_FIFO || sched_policies[i].policy == SCHED_RR;
+        if (realtime ? (priority < 1 || priority > 99) : priority != 0) {
+            return -1;
+        }
+        sched->policy   = sched_policies[i].policy;
+        sched->priority = priority;
+        return 0;
+    }
+    return -1;
+}
+
+// ioprio=<类>[:<级别>]，rt/be的级别为0-7（默认4），idle没有级别
+static int parse_ioprio(sched_policy_t *sched, const char *value) {
+    const char *colon = strchr(value, ':');
+    size_t len        = colon ? (size_t)(colon - value) : strlen(value);
+
+    long level = 4;
+    if (colon) {
+        char *end;
+        level = strtol(colon + 1, &end, 10);
+        if (end == colon + 1 || *end || level < 0 || level > 7) {
+            return -1;
+        }
+    }
+
+    for (int class = 1; class < (int)(sizeof(ioprio_classes) / sizeof(ioprio_classes[0])); class++) {
+        if (strlen(ioprio_classes[class]) != len || strncmp(value, ioprio_classes[class], len) != 0) {
+            continue;
+        }
+        if (class == 3) {
+            if (colon) {
+                return -1;
+            }
+            level = 0;
+        }
+        sched->ioprio = SCHED_IOPRIO_VALUE(class, level);
+        return 0;
+    }
+    return -1;
+}
+
+// 设置一项，选项名未知或值无效时返回-1且不修改
+int sched_policy_set(sched_policy_t *sched, const char *key, const char *value) {
+    if (strcmp(key, "cpus") == 0 || strcmp(key, "numa_node") == 0) {
+        int node   = key[0] == 'n';
+        char *text = node ? sched->nodes_text : sched->cpus_text;
+        cpu_set_t set;
+        if (strlen(value) >= SCHED_POLICY_TEXT_SIZE || (node ? parse_nodes(value, &set) : parse_list(value, &set)) < 0) {
+            return -1;
+        }
+        if (node) {
+            sched->node_cpus = set;
+        } else {
+            sched->cpus = set;
+        }
+        strcpy(text, value);
+        return 0;
+    }
+
+    if (strcmp(key, "sched") == 0) {
+        return parse_sched(sched, value);
+    }
+
+    if (strcmp(key, "nice") == 0) {
+        char *end;
+        long nice = strtol(value, &end, 10);
+        if (end == value || *end || nice < -20 || nice > 19) {
+            return -1;
+        }
+        sched->nice_set = 1;
+        sched->nice     = nice;
+        return 0;
+    }
+
+    if (strcmp(key, "ioprio") == 0) {
+        return parse_ioprio(sched, value);
+    }
+
+    return -1;
+}
+
+// 格式化为service_opt_parse可解析的形式，以空格开头，没有设置的项不输出
+size_t sched_policy_dump(const sched_policy_t *sched, char *buffer, size_t size) {
+    size_t len = 0;
+    buffer[0]  = '\0';
+
+    if (sched->cpus_text[0] && len < size) {
+        len += snprintf(buffer + len, size - len, " cpus=%s", sched->cpus_text);
+    }
+    if (sched->nodes_text[0] && len < size) {
+        len += snprintf(buffer + len, size - len, " numa_node=%s", sched->nodes_text);
+    }
+    for (size_t i = 0; i < sizeof(sched_policies) / sizeof(sched_policies[0]) && len < size; i++) {
+        if (sched->policy == sched_policies[i].policy) {
+            len += snprintf(buffer + len, size - len, " sched=%s:%d", sched_policies[i].name, sched->priority);
+        }
+    }
+    if (sched->nice_set && len < size) {
+        len += snprintf(buffer + len, size - len, " nice=%d", sched->nice);
+    }
+    if (sched->ioprio >= 0 && len < size) {
+        int class = sched->ioprio >> SCHED_IOPRIO_CLASS_SHIFT;
+        len += snprintf(buffer + len, size - len, (class == 3) ? " ioprio=%s" : " ioprio=%s:%d", ioprio_classes[class],
+                        sched->ioprio & ((1 << SCHED_IOPRIO_CLASS_SHIFT) - 1));
+    }
+    return (len < size) ? len : size - 1;
+}
+
+int sched_policy_used(const sched_policy_t *sched) {
+    return sched->cpus_text[0] || sched->nodes_text[0] || sched->policy >= 0 || sched->nice_set || sched->ioprio >= 0;
+}
+
+// 在子进程exec前调用，作用于调用者自身，失败时返回-1（errno为原因）。
+// 只使用系统调用，可在vfork出的子进程中调用
+int sched_policy_apply(const sched_policy_t *sched) {
+    if (sched->cpus_text[0] || sched->nodes_text[0]) {
+        cpu_set_t cpus;
+        if (sched->cpus_text[0] && sched->nodes_text[0]) {
+            CPU_AND(&cpus, &sched->cpus, &sched->node_cpus);
+        } else {
+            cpus = sched->cpus_text[0] ? sched->cpus : sched->node_cpus;
+        }
+        if (sched_setaffinity(0, sizeof(cpus), &cpus) < 0) {
+            return -1;
+        }
+    }
+
+    if (sched->policy >= 0) {
+        struct sched_param param = {.sched_priority = sched->priority};
+        if (sched_setscheduler(0, sched->policy, &param) < 0) {
+            return -1;
+        }
+    }
+
+    if (sched->nice_set && setpriority(PRIO_PROCESS, 0, sched->nice) < 0) {
+        return -1;
+    }
+
+    if (sched->ioprio >= 0 && syscall(SYS_ioprio_set, SCHED_IOPRIO_WHO_PROCESS, 0, sched->ioprio) < 0) {
+        return -1;
+    }
+    return 0;
+}
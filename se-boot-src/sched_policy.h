@@ -0,0 +1,36 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_SCHED_POLICY_H
+#define SE_BOOT_SCHED_POLICY_H
+
+#include <stddef.h>
+#include <sched.h>
+
+#define SCHED_POLICY_TEXT_SIZE (64)
+
+// 一个服务的CPU亲和性、调度策略、nice与I/O优先级，在fork与exec之间设置
+typedef struct sched_policy_t {
+    char cpus_text[SCHED_POLICY_TEXT_SIZE];  // 原样保留，用于转发给监管进程；空串表示不设置
+    char nodes_text[SCHED_POLICY_TEXT_SIZE];
+    cpu_set_t cpus;      // cpus=给出的CPU
+    cpu_set_t node_cpus; // numa_node=给出的节点上的CPU，与cpus同时设置时取交集
+    int policy;          // SCHED_*，-1表示不设置
+    int priority;        // SCHED_FIFO/SCHED_RR的优先级
+    int nice_set;
+    int nice;
+    int ioprio; // ioprio_set的值，-1表示不设置
+} sched_policy_t;
+
+void sched_policy_init(sched_policy_t *sched);
+int sched_policy_set(sched_policy_t *sched, const char *key, const char *value);
+size_t sched_policy_dump(const sched_policy_t *sched, char *buffer, size_t size);
+int sched_policy_used(const sched_policy_t *sched);
+int sched_policy_apply(const sched_policy_t *sched);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,262 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/wait.h>
+#include "se-boot-src/service.h"
+
+// 选项名与提供默认值的环境变量
+static const struct {
+    const char *key;
+    const char *env;
+} service_opt_env[] = {
+    {"restart", "SE_RESTART"},
+    {"restart_delay", "SE_RESTART_DELAY"},
+    {"restart_max_delay", "SE_RESTART_MAX_DELAY"},
+    {"restart_burst", "SE_RESTART_BURST"},
+    {"restart_window", "SE_RESTART_WINDOW"},
+    {"zygote", "SE_ZYGOTE"},
+    {"pty", "SE_PTY"},
+};
+
+static const char *restart_names[] = {"never", "on-failure", "always"};
+
+long service_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// 解析整数，格式错误或为负时返回-1
+static long parse_long(const char *value) {
+    char *end;
+    long result = strtol(value, &end, 10);
+    if (end == value || *end != '\0' || result < 0) {
+        return -1;
+    }
+    return result;
+}
+
+// 解析时长，单位为毫秒，支持ms/s/m后缀（例如500ms、2s），格式错误时返回-1
+static long parse_ms(const char *value) {
+    char *end;
+    long result = strtol(value, &end, 10);
+    if (end == value || result < 0) {
+        return -1;
+    }
+
+    if (*end == '\0' || strcmp(end, "ms") == 0) {
+        return result;
+    }
+    if (strcmp(end, "s") == 0) {
+        return result * 1000;
+    }
+    if (strcmp(end, "m") == 0) {
+        return result * 60 * 1000;
+    }
+    return -1;
+}
+
+void service_opt_init(service_opt_t *opt) {
+    opt->restart           = SERVICE_RESTART_NEVER;
+    opt->restart_delay     = 100;
+    opt->restart_max_delay = 30 * 1000;
+    opt->restart_burst     = 5;
+    opt->restart_window    = 60 * 1000;
+    opt->zygote            = 0;
+    opt->pty               = 0;
+    memset(&opt->cgroup, 0, sizeof(opt->cgroup));
+    sched_policy_init(&opt->sched);
+
+    for (size_t i = 0; i < sizeof(service_opt_env) / sizeof(service_opt_env[0]); i++) {
+        const char *value = getenv(service_opt_env[i].env);
+        if (value && *value) {
+            service_opt_set(opt, service_opt_env[i].key, value);
+        }
+    }
+}
+
+// 设置一个选项，选项名未知或值无效时返回-1且不修改
+int service_opt_set(service_opt_t *opt, const char *key, const char *value) {
+    long n;
+
+    if (strcmp(key, "restart") == 0) {
+        for (int i = 0; i < (int)(sizeof(restart_names) / sizeof(restart_names[0])); i++) {
+            if (strcmp(value, restart_names[i]) == 0) {
+                opt->restart = i;
+                return 0;
+            }
+        }
+        return -1;
+    }
+
+    long *ms = NULL;
+    if (strcmp(key, "restart_delay") == 0) {
+        ms = &opt->restart_delay;
+    } else if (strcmp(key, "restart_max_delay") == 0) {
+        ms = &opt->restart_max_delay;
+    } else if (strcmp(key, "restart_window") == 0) {
+        ms = &opt->restart_window;
+    }
+    if (ms) {
+        if ((n = parse_ms(value)) < 0) {
+            return -1;
+        }
+        *ms = n;
+        return 0;
+    }
+
+    if (strcmp(key, "restart_burst") == 0) {
+        if ((n = parse_long(value)) < 0) {
+            return -1;
+        }
+        opt->restart_burst = n;
+        return 0;
+    }
+
+    if (strcmp(key, "zygote") == 0) {
+        if ((n = parse_long(value)) < 0) {
+            return -1;
+        }
+        opt->zygote = n > 0;
+        return 0;
+    }
+
+    if (strcmp(key, "pty") == 0) {
+        if ((n = parse_long(value)) < 0) {
+            return -1;
+        }
+        opt->pty = n > 0;
+        return 0;
+    }
+
+    // cpus、numa_node、sched、nice、ioprio
+    if (sched_policy_set(&opt->sched, key, value) == 0) {
+        return 0;
+    }
+
+    // cgroup=1、cpu_max、cpu_weight、memory_max、memory_high、io_weight、pids_max
+    return cgroup_limits_set(&opt->cgroup, key, value);
+}
+
+// 解析以空白分隔的若干"key=value"（命令行选项、脚本元数据行、监管模式的启动请求共用），
+// 只有"key"时值为"1"；遇到无效项返回-1，此前的项已生效
+int service_opt_parse(service_opt_t *opt, const char *text) {
+    char token[256];
+
+    while (*text) {
+        while (isspace((unsigned char)*text)) {
+            text++;
+        }
+        size_t len = 0;
+        while (text[len] && !isspace((unsigned char)text[len])) {
+            len++;
+        }
+        if (len == 0) {
+            break;
+        }
+        if (len >= sizeof(token)) {
+            return -1;
+        }
+
+        memcpy(token, text, len);
+        token[len] = '\0';
+        text += len;
+
+        char *value = strchr(token, '=');
+        if (value) {
+            *value++ = '\0';
+        } else {
+            value = "1";
+        }
+        if (service_opt_set(opt, token, value) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 读取脚本开头的元数据行（"#se-boot: key=value ..."），文件无法读取时返回-1
+int service_opt_script(service_opt_t *opt, const char *path) {
+    char buffer[SERVICE_SCRIPT_HEAD + 1];
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t size = read(fd, buffer, SERVICE_SCRIPT_HEAD);
+    close(fd);
+    if (size < 0) {
+        return -1;
+    }
+    buffer[size] = '\0';
+
+    int ret    = 0;
+    char *line = buffer;
+    while (line && *line) {
+        char *next = strchr(line, '\n');
+        if (next) {
+            *next++ = '\0';
+        }
+        if (strncmp(line, SERVICE_SCRIPT_TAG, strlen(SERVICE_SCRIPT_TAG)) == 0) {
+            if (service_opt_parse(opt, line + strlen(SERVICE_SCRIPT_TAG)) < 0) {
+                ret = -1;
+            }
+        }
+        line = next;
+    }
+    return ret;
+}
+
+// 将全部选项格式化为service_opt_parse可解析的一行
+size_t service_opt_dump(const service_opt_t *opt, char *buffer, size_t size) {
+    size_t len = snprintf(buffer, size, "restart=%s restart_delay=%ld restart_max_delay=%ld restart_burst=%d restart_window=%ld zygote=%d pty=%d",
+                          restart_names[opt->restart], opt->restart_delay, opt->restart_max_delay, opt->restart_burst, opt->restart_window,
+                          opt->zygote, opt->pty);
+    if (len >= size) {
+        return size - 1;
+    }
+    len += cgroup_limits_dump(&opt->cgroup, buffer + len, size - len);
+    return len + sched_policy_dump(&opt->sched, buffer + len, size - len);
+}
+
+// 子进程退出后决定是否重启：返回重启前需等待的毫秒数，不重启时返回-1。
+// ran为子进程运行的时长；因崩溃循环放弃重启时在msg中给出原因，否则msg为空
+long service_restart_next(const service_opt_t *opt, service_restart_t *restart, int status, long ran, char *msg, size_t msg_size) {
+    msg[0] = '\0';
+
+    int failed = !(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    if (opt->restart == SERVICE_RESTART_NEVER || (opt->restart == SERVICE_RESTART_ON_FAILURE && !failed)) {
+        return -1;
+    }
+
+    long now = service_now();
+    if (ran >= opt->restart_window) {
+        restart->failures = 0;
+    }
+    if (restart->window_count == 0 || now - restart->window_start >= opt->restart_window) {
+        restart->window_start = now;
+        restart->window_count = 0;
+    }
+
+    if (opt->restart_burst > 0 && restart->window_count >= opt->restart_burst) {
+        snprintf(msg, msg_size, "crash loop: restarted %d times within %ld ms, giving up", restart->window_count, opt->restart_window);
+        return -1;
+    }
+
+    long delay = opt->restart_delay;
+    for (int i = 0; i < restart->failures && delay < opt->restart_max_delay; i++) {
+        delay *= 2;
+    }
+    if (delay > opt->restart_max_delay) {
+        delay = opt->restart_max_delay;
+    }
+
+    restart->failures++;
+    restart->window_count++;
+    restart->count++;
+    return delay;
+}
@@ -0,0 +1,54 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_SERVICE_H
+#define SE_BOOT_SERVICE_H
+
+#include <stddef.h>
+#include "se-boot-src/cgroup.h"
+#include "se-boot-src/sched_policy.h"
+
+#define SERVICE_RESTART_NEVER 0
+#define SERVICE_RESTART_ON_FAILURE 1
+#define SERVICE_RESTART_ALWAYS 2
+
+#define SERVICE_SCRIPT_HEAD (4096)         // 读取脚本元数据时只看文件开头
+#define SERVICE_SCRIPT_TAG "#se-boot:"     // 脚本中的元数据行，例如"#se-boot: restart=on-failure"
+
+// 单个后台程序的启动选项。默认值来自环境变量，可被命令行（se-boot --key=value <command>）
+// 或脚本元数据覆盖
+typedef struct service_opt_t {
+    int restart;            // SERVICE_RESTART_*
+    long restart_delay;     // 首次重启前的等待（毫秒），之后每次连续失败翻倍
+    long restart_max_delay; // 等待的上限（毫秒）
+    int restart_burst;      // restart_window内最多重启的次数，超过后视为崩溃循环不再重启
+    long restart_window;    // 毫秒；程序运行超过该时长后退避重新从restart_delay开始
+    int zygote;             // 预先fork好下一个子进程，重启时只需exec
+    int pty;                // stdout使用伪终端，子进程按行缓冲
+    cgroup_limits_t cgroup; // 每次运行放入独立的cgroup v2叶子并设置限制
+    sched_policy_t sched;   // 在fork与exec之间设置的CPU亲和性、调度策略、nice与I/O优先级
+} service_opt_t;
+
+// 重启状态
+typedef struct service_restart_t {
+    int count;         // 累计重启次数
+    int failures;      // 连续的短时间退出次数，决定退避时长
+    long window_start; // 当前计数窗口的起点（毫秒，单调时钟）
+    int window_count;  // 窗口内的重启次数
+} service_restart_t;
+
+void service_opt_init(service_opt_t *opt);
+int service_opt_set(service_opt_t *opt, const char *key, const char *value);
+int service_opt_parse(service_opt_t *opt, const char *text);
+int service_opt_script(service_opt_t *opt, const char *path);
+size_t service_opt_dump(const service_opt_t *opt, char *buffer, size_t size);
+
+long service_now();
+long service_restart_next(const service_opt_t *opt, service_restart_t *restart, int status, long ran, char *msg, size_t msg_size);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/wait.h>
+#include "se-boot-src/service_ctl.h"
+#include "se-boot-src/service_table.h"
+#include "se-boot-src/conf.h"
+
+#define SERVICE_CTL_POLL_MS (20)
+#define SERVICE_CTL_DEFAULT_TIMEOUT (5000) // SIGTERM后等待的时间（毫秒），超时后SIGKILL
+
+static void ctl_sleep(long ms) {
+    struct timespec ts = {ms / 1000, (ms % 1000) * 1000000};
+    nanosleep(&ts, NULL);
+}
+
+static long ctl_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// 按名称、路径或pid匹配，没有给出参数时匹配全部
+static int ctl_match(const service_entry_t *entry, int argc, char **argv) {
+    if (argc == 0) {
+        return 1;
+    }
+    for (int i = 0; i < argc; i++) {
+        char *end;
+        long pid = strtol(argv[i], &end, 10);
+        if (*end == '\0' && pid == entry->pid) {
+            return 1;
+        }
+        if (strcmp(argv[i], entry->name) == 0 || strcmp(argv[i], entry->path) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static const char *ctl_state(const service_entry_t *entry, char *buffer, size_t size) {
+    int owned = service_table_owned(entry);
+    switch (entry->state) {
+    case SERVICE_STATE_RUNNING:
+        return owned ? "running" : "lost";
+    case SERVICE_STATE_BACKOFF:
+        return owned ? "backoff" : "lost";
+    case SERVICE_STATE_STOPPED:
+        return "stopped";
+    case SERVICE_STATE_EXITED:
+        if (WIFSIGNALED(entry->exit_status)) {
+            snprintf(buffer, size, "killed(%d)", WTERMSIG(entry->exit_status));
+        } else {
+            snprintf(buffer, size, "exited(%d)", WEXITSTATUS(entry->exit_status));
+        }
+        return buffer;
+    }
+    return "unknown";
+}
+
+static const char *ctl_uptime(long ms, char *buffer, size_t size) {
+    long sec = (ms < 0) ? 0 : ms / 1000;
+    if (sec < 60) {
+        snprintf(buffer, size, "%lds", sec);
+    } else if (sec < 3600) {
+        snprintf(buffer, size, "%ldm%02lds", sec / 60, sec % 60);
+    } else if (sec < 86400) {
+        snprintf(buffer, size, "%ldh%02ldm", sec / 3600, sec % 3600 / 60);
+    } else {
+        snprintf(buffer, size, "%ldd%02ldh", sec / 86400, sec % 86400 / 3600);
+    }
+    return buffer;
+}
+
+// 只读取服务表，不访问日志
+static int ctl_status(int argc, char **argv) {
+    int found = 0;
+    int count = service_table_count();
+    long now  = ctl_now();
+
+    printf("%-20s %-8s %-12s %-8s %-8s %s\n", "NAME", "PID", "STATE", "RESTARTS", "UPTIME", "PATH");
+    for (int i = 0; i < count; i++) {
+        service_entry_t entry;
+        if (service_table_read(i, &entry) < 0 || !ctl_match(&entry, argc, argv)) {
+            continue;
+        }
+
+        char state[32];
+        char uptime[32] = "-";
+        if (entry.state == SERVICE_STATE_RUNNING && service_table_owned(&entry)) {
+            ctl_uptime(now - entry.started, uptime, sizeof(uptime));
+        }
+        printf("%-20s %-8d %-12s %-8d %-8s %s\n", entry.name, entry.pid, ctl_state(&entry, state, sizeof(state)), entry.restarts,
+               uptime, entry.path);
+        found++;
+    }
+    return (argc > 0 && found == 0) ? -1 : 0;
+}
+
+// 等待持有者处理完请求：stop等待持有者释放该项，restart等待新的子进程启动
+static int ctl_done(int index, const service_entry_t *before, int request) {
+    service_entry_t entry;
+    if (service_table_read(index, &entry) < 0 || entry.owner != before->owner || !service_table_owned(&entry)) {
+        return 1;
+    }
+    if (request == SERVICE_REQUEST_RESTART) {
+        // 新的子进程可能很快再次退出，只看pid是否变化
+        return entry.pid != before->pid;
+    }
+    return 0;
+}
+
+static int ctl_wait(int index, const service_entry_t *before, int request, long timeout) {
+    for (long waited = 0; waited < timeout; waited += SERVICE_CTL_POLL_MS) {
+        if (ctl_done(index, before, request)) {
+            return 0;
+        }
+        ctl_sleep(SERVICE_CTL_POLL_MS);
+    }
+    return ctl_done(index, before, request) ? 0 : -1;
+}
+
+// 发出请求后向正在运行的子进程发送SIGTERM，超时后SIGKILL；等待重启的服务由持有者自行处理请求
+static int ctl_request(int index, const service_entry_t *entry, int request) {
+    const char *action = (request == SERVICE_REQUEST_STOP) ? "stop" : "restart";
+
+    int posted = -1;
+    if (!service_table_owned(entry)) {
+        errno = ESRCH;
+    } else {
+        posted = service_table_post(index, entry, request);
+    }
+    if (posted < 0) {
+        if (errno == EPERM) {
+            printf("%s (%d): %s failed: %s\n", entry->name, entry->pid, action, strerror(errno));
+        } else {
+            printf("%s (%d): not running\n", entry->name, entry->pid);
+        }
+        return -1;
+    }
+
+    long timeout = conf_long("SE_STOP_TIMEOUT", SERVICE_CTL_DEFAULT_TIMEOUT);
+    if (entry->state == SERVICE_STATE_RUNNING) {
+        if (service_table_signal(entry, SIGTERM) < 0 && errno != ESRCH) {
+            printf("%s (%d): %s failed: %s\n", entry->name, entry->pid, action, strerror(errno));
+            service_table_post(index, entry, SERVICE_REQUEST_NONE);
+            return -1;
+        }
+        if (ctl_wait(index, entry, request, timeout) < 0) {
+            printf("%s (%d): no exit after %ld ms, sending SIGKILL\n", entry->name, entry->pid, timeout);
+            service_table_signal(entry, SIGKILL);
+        }
+    }
+
+    if (ctl_wait(index, entry, request, timeout) < 0) {
+        printf("%s (%d): %s timed out\n", entry->name, entry->pid, action);
+        return -1;
+    }
+
+    service_entry_t after;
+    if (request == SERVICE_REQUEST_RESTART && service_table_read(index, &after) == 0 && after.pid != entry->pid) {
+        printf("%s (%d): restarted as %d\n", entry->name, entry->pid, after.pid);
+    } else {
+        printf("%s (%d): %s\n", entry->name, entry->pid, (request == SERVICE_REQUEST_STOP) ? "stopped" : "restart failed");
+    }
+    return 0;
+}
+
+// se-boot stop|restart|status [name|path|pid ...]
+int service_ctl_main(int argc, char **argv) {
+    const char *command = argv[1];
+    argc -= 2;
+    argv += 2;
+
+    if (strcmp(command, "status") == 0) {
+        return ctl_status(argc, argv);
+    }
+
+    if (argc == 0) {
+        printf("usage: se-boot %s <name|path|pid> ...\n", command);
+        return -1;
+    }
+
+    int request = (strcmp(command, "stop") == 0) ? SERVICE_REQUEST_STOP : SERVICE_REQUEST_RESTART;
+    int found   = 0;
+    int ret     = 0;
+    int count   = service_table_count();
+    for (int i = 0; i < count; i++) {
+        service_entry_t entry;
+        if (service_table_read(i, &entry) < 0 || !ctl_match(&entry, argc, argv) || !service_table_owned(&entry)) {
+            continue;
+        }
+        found++;
+        if (ctl_request(i, &entry, request) < 0) {
+            ret = -1;
+        }
+    }
+
+    if (found == 0) {
+        printf("no running service matches\n");
+        return -1;
+    }
+    return ret;
+}
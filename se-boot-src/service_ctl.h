@@ -0,0 +1,14 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_SERVICE_CTL_H
+#define SE_BOOT_SERVICE_CTL_H
+
+int service_ctl_main(int argc, char **argv);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
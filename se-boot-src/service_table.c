@@ -0,0 +1,396 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include "se-boot-src/service_table.h"
+#include "se-boot-src/path.h"
+
+#define SERVICE_TABLE_MAGIC (0x53455354) // "SEST"
+#define SERVICE_TABLE_READ_RETRY (1000)  // 写入者在写入期间退出时seq保持为奇数，读取时有限次重试
+
+// 文件布局：头部 + SERVICE_TABLE_SLOTS个定长项，大小固定，由第一个使用者创建
+typedef struct service_table_header_t {
+    uint32_t magic;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    uint32_t reserved;
+} service_table_header_t;
+
+static service_table_header_t *table = NULL;
+static int table_writable             = 0;
+
+static service_entry_t *table_slot(int index) {
+    return (service_entry_t *)(table + 1) + index;
+}
+
+// 映射服务表，create为真时不存在则创建（监视进程/监管进程），否则只打开已有的（se-boot status等）。
+// 服务表只有创建者与root可写：其他用户只读映射（可以status，不能stop/restart），
+// 持有者只使用属于自己或root的服务表，以免其他用户伪造表项或请求。
+// 旧版本留下的格式不同的服务表由其所有者删除后重新创建，仍在运行的旧进程继续使用它已映射的文件
+static int table_open(int create, int recreate) {
+    int writable = 1;
+    int fd       = open(SE_SERVICE_TABLE, O_RDWR | O_CLOEXEC | (create ? O_CREAT : 0), 0644);
+    if (fd < 0 && !create && errno == EACCES) {
+        writable = 0;
+        fd       = open(SE_SERVICE_TABLE, O_RDONLY | O_CLOEXEC);
+    }
+    if (fd < 0) {
+        return -1;
+    }
+
+    size_t size = sizeof(service_table_header_t) + SERVICE_TABLE_SLOTS * sizeof(service_entry_t);
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (create && st.st_uid != 0 && st.st_uid != geteuid())) {
+        close(fd);
+        return -1;
+    }
+
+    // 旧版本创建的服务表对所有用户可写，收回其他用户的写权限
+    if (create && st.st_uid == geteuid() && (st.st_mode & 022)) {
+        fchmod(fd, st.st_mode & 0755);
+    }
+
+    // 多个进程同时创建时ftruncate到相同大小，新增部分为0，不会互相破坏
+    if (st.st_size < (off_t)size) {
+        if (!create || ftruncate(fd, size) < 0) {
+            close(fd);
+            return -1;
+        }
+    }
+
+    void *addr = mmap(NULL, size, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return -1;
+    }
+
+    // 只初始化新建的服务表；同时创建的进程写入相同的值
+    service_table_header_t *header = addr;
+    if (create && __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) == 0) {
+        header->slot_count = SERVICE_TABLE_SLOTS;
+        header->slot_size  = sizeof(service_entry_t);
+        uint32_t expected  = 0;
+        __atomic_compare_exchange_n(&header->magic, &expected, SERVICE_TABLE_MAGIC, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+    }
+
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != SERVICE_TABLE_MAGIC ||
+        header->slot_count != SERVICE_TABLE_SLOTS || header->slot_size != sizeof(service_entry_t)) {
+        munmap(addr, size);
+        if (create && recreate && st.st_uid == geteuid() && unlink(SE_SERVICE_TABLE) == 0) {
+            return table_open(create, 0);
+        }
+        return -1;
+    }
+
+    table          = header;
+    table_writable = writable;
+    return 0;
+}
+
+static int table_map(int create) {
+    return table ? 0 : table_open(create, 1);
+}
+
+static long now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// 读取进程的启动时间（自系统启动的时钟滴答数），失败返回0
+static uint64_t proc_start_time(pid_t pid) {
+    char path[64];
+    char buffer[1024];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    ssize_t len = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (len <= 0) {
+        return 0;
+    }
+    buffer[len] = '\0';
+
+    // comm中可能有空格与括号，从最后一个')'之后开始数：第3项为state，第22项为starttime
+    char *p = strrchr(buffer, ')');
+    if (!p) {
+        return 0;
+    }
+    p += 2;
+    for (int field = 3; field < 22; field++) {
+        p = strchr(p, ' ');
+        if (!p) {
+            return 0;
+        }
+        p++;
+    }
+    return strtoull(p, NULL, 10);
+}
+
+// 持有者标识：pid与启动时间一起比较，持有者退出后pid被复用时不会被误认为仍在运行
+static uint64_t owner_token(pid_t pid) {
+    return ((uint64_t)(uint32_t)proc_start_time(pid) << 32) | (uint32_t)pid;
+}
+
+static int owner_alive(uint64_t owner) {
+    pid_t pid = (pid_t)(uint32_t)owner;
+    if (pid <= 0 || (kill(pid, 0) < 0 && errno != EPERM)) {
+        return 0;
+    }
+    return owner_token(pid) == owner;
+}
+
+// 写入开始/结束：写入期间seq为奇数。上一个写入者中途退出时seq已是奇数，跳过一个值保持奇数
+static uint32_t entry_begin(service_entry_t *entry) {
+    uint32_t seq = __atomic_load_n(&entry->seq, __ATOMIC_RELAXED);
+    seq += (seq & 1) ? 2 : 1;
+    __atomic_store_n(&entry->seq, seq, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return seq;
+}
+
+static void entry_end(service_entry_t *entry, uint32_t seq) {
+    __atomic_store_n(&entry->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+static int entry_take(service_entry_t *entry, uint64_t owner, uint64_t self) {
+    return __atomic_compare_exchange_n(&entry->owner, &owner, self, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+// 为一个服务占用一项：优先复用同一路径的旧记录（使status中每个服务只保留最近一次），
+// 其次是从未使用的项，最后是任意无人持有的项。服务表不可用或已满时返回NULL，不影响服务运行
+service_entry_t *service_table_claim(const char *path, const char *name) {
+    if (table_map(1) < 0) {
+        return NULL;
+    }
+
+    uint64_t self          = owner_token(getpid());
+    service_entry_t *entry = NULL;
+    for (int pass = 0; pass < 3 && !entry; pass++) {
+        for (int i = 0; i < SERVICE_TABLE_SLOTS; i++) {
+            service_entry_t *slot = table_slot(i);
+            uint64_t owner        = __atomic_load_n(&slot->owner, __ATOMIC_ACQUIRE);
+            if (owner_alive(owner)) {
+                continue;
+            }
+            if (pass == 0 && strncmp(slot->path, path, SERVICE_PATH_SIZE) != 0) {
+                continue;
+            }
+            if (pass == 1 && slot->state != SERVICE_STATE_FREE) {
+                continue;
+            }
+            if (entry_take(slot, owner, self)) {
+                entry = slot;
+                break;
+            }
+        }
+    }
+    if (!entry) {
+        return NULL;
+    }
+
+    uint32_t seq = entry_begin(entry);
+    entry->pid         = 0;
+    entry->uid         = geteuid();
+    entry->state       = SERVICE_STATE_RUNNING;
+    entry->restarts    = 0;
+    entry->exit_status = 0;
+    entry->start_time  = 0;
+    entry->started     = 0;
+    strncpy(entry->name, name, SERVICE_NAME_SIZE - 1);
+    entry->name[SERVICE_NAME_SIZE - 1] = '\0';
+    strncpy(entry->path, path, SERVICE_PATH_SIZE - 1);
+    entry->path[SERVICE_PATH_SIZE - 1] = '\0';
+    entry_end(entry, seq);
+
+    __atomic_store_n(&entry->request, SERVICE_REQUEST_NONE, __ATOMIC_RELEASE);
+    return entry;
+}
+
+// 更新状态；pid变化时记录新子进程的启动时间
+void service_table_set(service_entry_t *entry, int state, pid_t pid, int restarts, int exit_status) {
+    if (!entry) {
+        return;
+    }
+
+    uint64_t start_time = entry->start_time;
+    int64_t started     = entry->started;
+    if (pid != entry->pid) {
+        start_time = proc_start_time(pid);
+        started    = now_ms();
+    }
+
+    uint32_t seq = entry_begin(entry);
+    entry->pid         = pid;
+    entry->state       = state;
+    entry->restarts    = restarts;
+    entry->exit_status = exit_status;
+    entry->start_time  = start_time;
+    entry->started     = started;
+    entry_end(entry, seq);
+}
+
+// 服务不再运行：保留最后的状态供status查看，释放持有权
+void service_table_release(service_entry_t *entry, int state, int exit_status) {
+    if (!entry) {
+        return;
+    }
+
+    uint32_t seq = entry_begin(entry);
+    entry->state       = state;
+    entry->exit_status = exit_status;
+    entry_end(entry, seq);
+
+    __atomic_store_n(&entry->request, SERVICE_REQUEST_NONE, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry->owner, 0, __ATOMIC_RELEASE);
+}
+
+// 取出待处理的stop/restart请求，只接受root或与持有者相同用户发出的请求
+int service_table_request(service_entry_t *entry) {
+    if (!entry) {
+        return SERVICE_REQUEST_NONE;
+    }
+    int request = __atomic_exchange_n(&entry->request, SERVICE_REQUEST_NONE, __ATOMIC_ACQ_REL);
+    uint32_t uid = __atomic_load_n(&entry->request_uid, __ATOMIC_RELAXED);
+    if (uid != 0 && uid != entry->uid) {
+        return SERVICE_REQUEST_NONE;
+    }
+    return request;
+}
+
+// 退避等待：每SERVICE_TABLE_POLL_MS检查一次请求，有请求时提前返回该请求，否则等满后返回0
+int service_table_wait(service_entry_t *entry, long ms) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    end.tv_sec += ms / 1000;
+    end.tv_nsec += (ms % 1000) * 1000000;
+    if (end.tv_nsec >= 1000000000) {
+        end.tv_sec++;
+        end.tv_nsec -= 1000000000;
+    }
+
+    while (1) {
+        int request = service_table_request(entry);
+        if (request != SERVICE_REQUEST_NONE) {
+            return request;
+        }
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long left = (end.tv_sec - now.tv_sec) * 1000 + (end.tv_nsec - now.tv_nsec) / 1000000;
+        if (left <= 0) {
+            return SERVICE_REQUEST_NONE;
+        }
+        if (entry && left > SERVICE_TABLE_POLL_MS) {
+            left = SERVICE_TABLE_POLL_MS;
+        }
+
+        struct timespec ts = {left / 1000, (left % 1000) * 1000000};
+        nanosleep(&ts, NULL);
+    }
+}
+
+// 服务表的项数，服务表不存在时为0
+int service_table_count() {
+    return (table_map(0) < 0) ? 0 : SERVICE_TABLE_SLOTS;
+}
+
+// 读取一项的一致快照，未使用过或读取失败时返回-1
+int service_table_read(int index, service_entry_t *entry) {
+    service_entry_t *slot = table_slot(index);
+    for (int i = 0; i < SERVICE_TABLE_READ_RETRY; i++) {
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            sched_yield();
+            continue;
+        }
+        memcpy(entry, slot, sizeof(service_entry_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq) {
+            return (entry->state == SERVICE_STATE_FREE) ? -1 : 0;
+        }
+    }
+    return -1;
+}
+
+// 快照中的持有者是否仍在运行
+int service_table_owned(const service_entry_t *entry) {
+    return owner_alive(entry->owner);
+}
+
+// 向持有者发出stop/restart请求，持有者已变化时返回-1（errno为ESRCH），
+// 服务表不可写或请求者既不是root也不是持有者的用户时返回-1（errno为EPERM）
+int service_table_post(int index, const service_entry_t *entry, int request) {
+    service_entry_t *slot = table_slot(index);
+    uid_t uid             = geteuid();
+    if (!table_writable || (uid != 0 && uid != entry->uid)) {
+        errno = EPERM;
+        return -1;
+    }
+    if (__atomic_load_n(&slot->owner, __ATOMIC_ACQUIRE) != entry->owner || !owner_alive(entry->owner)) {
+        errno = ESRCH;
+        return -1;
+    }
+    __atomic_store_n(&slot->request_uid, uid, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->request, request, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// 子进程是进程组组长时再向整个进程组发送（sh -c等启动的进程持有输出管道，只终止子进程时监视进程等不到EOF）。
+// 调用前已确认pid属于该子进程：子进程在被回收前（包括僵尸状态）一直占用该pid，进程组id也随之不会被复用
+static int signal_group(pid_t pid, int sig, int ret) {
+    if (getpgid(pid) == pid && kill(-pid, sig) == 0) {
+        return 0;
+    }
+    return ret;
+}
+
+// 向快照中的子进程发送信号。先取得pidfd再比对启动时间：比对通过则pidfd指向的就是该子进程，
+// 之后通过pidfd发送，期间即使子进程退出、pid被复用也不会发给其他进程；
+// 内核不支持pidfd时退回按pid发送（比对与发送之间pid仍可能被复用）
+int service_table_signal(const service_entry_t *entry, int sig) {
+    if (entry->pid <= 0) {
+        errno = ESRCH;
+        return -1;
+    }
+
+#if defined(SYS_pidfd_open) && defined(SYS_pidfd_send_signal)
+    int pidfd = syscall(SYS_pidfd_open, entry->pid, 0);
+    if (pidfd < 0 && errno != ENOSYS) {
+        return -1;
+    }
+#else
+    int pidfd = -1;
+#endif
+
+    int ret = -1;
+    if (entry->start_time != 0 && proc_start_time(entry->pid) != entry->start_time) {
+        errno = ESRCH;
+    } else if (pidfd >= 0) {
+#if defined(SYS_pidfd_send_signal)
+        ret = syscall(SYS_pidfd_send_signal, pidfd, sig, NULL, 0);
+#endif
+        ret = signal_group(entry->pid, sig, ret);
+    } else {
+        ret = signal_group(entry->pid, sig, kill(entry->pid, sig));
+    }
+
+    if (pidfd >= 0) {
+        int err = errno;
+        close(pidfd);
+        errno = err;
+    }
+    return ret;
+}
@@ -0,0 +1,60 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_SERVICE_TABLE_H
+#define SE_BOOT_SERVICE_TABLE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#define SERVICE_TABLE_SLOTS (1024)
+#define SERVICE_NAME_SIZE (64)
+#define SERVICE_PATH_SIZE (176)
+#define SERVICE_TABLE_POLL_MS (100) // 退避等待期间检查stop/restart请求的间隔
+
+#define SERVICE_STATE_FREE 0
+#define SERVICE_STATE_RUNNING 1
+#define SERVICE_STATE_BACKOFF 2 // 已退出，等待重启
+#define SERVICE_STATE_STOPPED 3 // 通过se-boot stop停止
+#define SERVICE_STATE_EXITED 4  // 退出且不再重启，exit_status为waitpid的状态
+
+#define SERVICE_REQUEST_NONE 0
+#define SERVICE_REQUEST_STOP 1
+#define SERVICE_REQUEST_RESTART 2
+
+// 服务表中的一项，只由owner（监视进程或监管进程）写入，写入期间seq为奇数；
+// request由se-boot stop/restart写入，owner处理后清零，request_uid不是0也不是uid时忽略该请求
+typedef struct service_entry_t {
+    uint32_t seq;
+    int32_t pid;
+    int32_t state;
+    int32_t restarts;
+    int32_t exit_status;
+    int32_t request;
+    uint32_t uid;         // 持有者的有效uid
+    uint32_t request_uid; // 发出request的用户
+    uint64_t owner;      // 持有者的pid（低32位）与启动时间的低32位，以CAS整体占用，0表示无人持有
+    uint64_t start_time; // 子进程的启动时间（/proc/<pid>/stat第22项），发送信号前用于确认pid未被复用
+    int64_t started;     // 子进程的启动时间（毫秒时间戳），用于显示
+    char name[SERVICE_NAME_SIZE];
+    char path[SERVICE_PATH_SIZE];
+} service_entry_t;
+
+service_entry_t *service_table_claim(const char *path, const char *name);
+void service_table_set(service_entry_t *entry, int state, pid_t pid, int restarts, int exit_status);
+void service_table_release(service_entry_t *entry, int state, int exit_status);
+int service_table_request(service_entry_t *entry);
+int service_table_wait(service_entry_t *entry, long ms);
+
+int service_table_count();
+int service_table_read(int index, service_entry_t *entry);
+int service_table_owned(const service_entry_t *entry);
+int service_table_post(int index, const service_entry_t *entry, int request);
+int service_table_signal(const service_entry_t *entry, int sig);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
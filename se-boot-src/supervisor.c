@@ -0,0 +1,767 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <libgen.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <pwd.h>
+#include <grp.h>
+#include <sched.h>
+#include <time.h>
+#include "se-boot-src/supervisor.h"
+#include "se-boot-src/capture.h"
+#include "se-boot-src/log.h"
+#include "se-boot-src/path.h"
+#include "se-boot-src/proc.h"
+#include "se-boot-src/service.h"
+#include "se-boot-src/service_table.h"
+#include "se-boot-src/cgroup.h"
+
+#define SUPERVISOR_EVENTS (64)           // 单次epoll_wait最多处理的事件数
+#define SUPERVISOR_RECV_TIMEOUT (1)      // 接收启动请求的超时（秒），避免异常客户端阻塞监管进程
+#define SUPERVISOR_REPLY_TIMEOUT (5)     // 客户端等待回复的超时（秒）
+#define SUPERVISOR_STACK_SIZE (64 * 1024) // clone出的子进程在exec前使用的栈
+#define SUPERVISOR_GROUPS (64)           // 请求方附加组的初始缓冲区大小，不够时按实际数量重新分配
+
+extern char **environ;
+
+// 启动请求：头部后依次为工作目录、选项（service_opt_dump的格式）、argc个参数、envc个环境变量，均以'\0'结尾
+typedef struct supervisor_head_t {
+    uint32_t argc;
+    uint32_t envc;
+} supervisor_head_t;
+
+struct service_t;
+
+// epoll事件对应的fd：index < CAPTURE_STREAMS为输出管道，等于CAPTURE_STREAMS为pidfd
+typedef struct service_watch_t {
+    struct service_t *service;
+    int index;
+} service_watch_t;
+
+// 监管进程持有的一个后台程序
+typedef struct service_t {
+    struct service_t *next;
+    pid_t pid;
+    int pidfd;
+    int stdin_fd; // 子进程stdin管道的写端，与process_run一致保持打开直到子进程退出；伪终端模式下为-1
+    int exited;
+    int reap_error; // wait4失败时的errno，此时没有退出状态
+    int status;
+    struct rusage usage; // wait4得到的资源用量
+    char *path;
+    char *name;
+
+    // 启动请求的副本，重启时沿用
+    char *request;
+    char **strings;
+    struct ucred cred;
+    gid_t *groups; // 请求方的附加组，切换身份时原样设置
+    int group_count;
+    const char *cwd;
+    char **argv;
+    char **envp;
+
+    service_opt_t opt;
+    service_restart_t restart;
+    service_entry_t *entry; // 服务表中的项，不可用时为NULL
+    cgroup_t cgroup;        // 本次运行所在的叶子cgroup
+    long start;      // 本次启动的时间（毫秒，单调时钟）
+    long start_us;   // 本次启动的时间（微秒），用于退出记录中的运行时长
+    long exit_us;    // 发现退出的时间（微秒），用于计算恢复耗时
+    long delay;      // 本次重启的退避等待
+    long restart_at; // 等待重启时为重启的时间，否则为-1
+
+    capture_t capture;
+    service_watch_t watches[CAPTURE_STREAMS + 1];
+} service_t;
+
+static service_t *services = NULL;
+static int supervisor_epfd  = -1;
+
+static int pidfd_open(pid_t pid, unsigned int flags) {
+    return syscall(SYS_pidfd_open, pid, flags);
+}
+
+// 是否启用监管模式，由环境变量SE_SUPERVISOR控制
+int supervisor_enabled() {
+    const char *value = getenv("SE_SUPERVISOR");
+    return value && atoi(value) > 0;
+}
+
+// 创建并监听控制套接字，调用者需持有SE_LOCK以保证唯一；内核不支持pidfd时返回-1
+int supervisor_open() {
+    int probe = pidfd_open(getpid(), 0);
+    if (probe < 0) {
+        return -1;
+    }
+    close(probe);
+
+    int ctl_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (ctl_fd < 0) {
+        return -1;
+    }
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family         = AF_UNIX;
+    strncpy(addr.sun_path, SE_CTL_SOCK, sizeof(addr.sun_path) - 1);
+
+    // 删除上次残留的套接字文件
+    unlink(SE_CTL_SOCK);
+
+    if (bind(ctl_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(ctl_fd, SOMAXCONN) < 0) {
+        close(ctl_fd);
+        return -1;
+    }
+
+    // 允许其他用户通过监管进程启动后台程序，以请求方的身份运行
+    chmod(SE_CTL_SOCK, 0666);
+    return ctl_fd;
+}
+
+// 客户端：将启动请求发给监管进程。返回后台程序的pid（已发出但未收到回复或命令无法执行时为0），
+// 未启用监管模式或监管进程拒绝时返回-1，由调用者自行启动
+int supervisor_request(const char **argv, const service_opt_t *opt) {
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family         = AF_UNIX;
+    strncpy(addr.sun_path, SE_CTL_SOCK, sizeof(addr.sun_path) - 1);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    char *buffer = malloc(SUPERVISOR_REQUEST_MAX);
+    if (!buffer) {
+        close(fd);
+        return -1;
+    }
+
+    supervisor_head_t head = {0, 0};
+    size_t len             = sizeof(head);
+    int overflow           = 0;
+
+    char cwd[4096];
+    if (!getcwd(cwd, sizeof(cwd))) {
+        strcpy(cwd, "/");
+    }
+
+    // 选项在客户端按其环境变量与命令行确定
+    char options[1024];
+    service_opt_dump(opt, options, sizeof(options));
+
+#define REQUEST_PUT(str)                                      \
+    do {                                                      \
+        size_t n = strlen(str) + 1;                           \
+        if (len + n > SUPERVISOR_REQUEST_MAX) {               \
+            overflow = 1;                                     \
+        } else {                                              \
+            memcpy(buffer + len, (str), n);                   \
+            len += n;                                         \
+        }                                                     \
+    } while (0)
+
+    REQUEST_PUT(cwd);
+    REQUEST_PUT(options);
+    for (const char **arg = argv; *arg; arg++, head.argc++) {
+        REQUEST_PUT(*arg);
+    }
+    for (char **env = environ; env && *env; env++, head.envc++) {
+        REQUEST_PUT(*env);
+    }
+#undef REQUEST_PUT
+    memcpy(buffer, &head, sizeof(head));
+
+    if (overflow || send(fd, buffer, len, MSG_NOSIGNAL) != (ssize_t)len) {
+        free(buffer);
+        close(fd);
+        return -1;
+    }
+    free(buffer);
+
+    struct timeval tv = {SUPERVISOR_REPLY_TIMEOUT, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    int32_t reply = 0;
+    ssize_t ret   = recv(fd, &reply, sizeof(reply), 0);
+    close(fd);
+
+    // 请求已送达，即使没有收到回复也不能再自行启动，否则可能启动两次
+    if (ret != sizeof(reply)) {
+        return 0;
+    }
+    return (reply >= 0) ? reply : -1;
+}
+
+static int service_watch(service_t *service, int fd, int index) {
+    service_watch_t *watch   = &service->watches[index];
+    watch->service           = service;
+    watch->index             = index;
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = watch};
+    return epoll_ctl(supervisor_epfd, EPOLL_CTL_ADD, fd, &event);
+}
+
+static void service_free(service_t *service) {
+    free(service->path);
+    free(service->name);
+    free(service->request);
+    free(service->strings);
+    free(service->groups);
+    free(service);
+}
+
+// 传给clone出的子进程的参数，子进程与监管进程共享内存，exec前的错误通过error返回
+typedef struct service_spawn_t {
+    const struct ucred *cred;
+    const gid_t *groups;
+    int group_count;
+    const char *cwd;
+    char **argv;
+    char **envp;
+    int fds[3]; // stdin/stdout/stderr
+    const cgroup_t *cgroup;
+    const sched_policy_t *sched;
+    const sigset_t *mask;
+    int error;
+} service_spawn_t;
+
+// clone(CLONE_VM|CLONE_VFORK)出的子进程：切换到请求方的身份与工作目录后执行命令。
+// 与监管进程共享内存，只能使用系统调用，不能调用log_write/malloc等；glibc的setuid等会与其他线程同步，改用syscall
+static int service_child(void *arg) {
+    service_spawn_t *spawn = arg;
+
+    // 没有CLONE_SIGHAND，信号处理函数是独立的一份，恢复默认后再解除屏蔽
+    signal(SIGTERM, SIG_DFL);
+    signal(SIGINT, SIG_DFL);
+    sigprocmask(SIG_SETMASK, spawn->mask, NULL);
+
+    // 与daemonize一致，后台程序位于独立的会话中
+    setsid();
+    umask(0);
+
+    // 在切换身份前加入cgroup，cgroup.procs只有root可写
+    if (cgroup_enter(spawn->cgroup) < 0) {
+        spawn->error = errno;
+        _exit(127);
+    }
+
+    const struct ucred *cred = spawn->cred;
+    if (cred->uid != geteuid() || cred->gid != getegid()) {
+        if (syscall(SYS_setgroups, spawn->group_count, spawn->groups) < 0 || syscall(SYS_setgid, cred->gid) < 0 || syscall(SYS_setuid, cred->uid) < 0) {
+            spawn->error = errno;
+            _exit(127);
+        }
+    }
+
+    // 调度参数在切换身份后设置，由内核按请求方的权限检查实时策略、负的nice等，与自行启动时一致
+    if (sched_policy_apply(spawn->sched) < 0) {
+        spawn->error = errno;
+        _exit(127);
+    }
+
+    if (chdir(spawn->cwd) < 0) {
+        spawn->error = errno;
+        _exit(127);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        if (dup2(spawn->fds[i], i) < 0) {
+            spawn->error = errno;
+            _exit(127);
+        }
+    }
+    // 不继承boot守护进程的锁文件等未设置CLOEXEC的fd
+    close_fds(3);
+
+    // execvp按当前environ中的PATH查找命令；监管进程在子进程exec之前一直挂起，返回后恢复environ
+    environ = spawn->envp;
+    execvp(spawn->argv[0], spawn->argv);
+    spawn->error = errno;
+    _exit(127);
+}
+
+static long now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// 启动（或重启）一个后台程序并开始捕获其输出，返回pid；命令无法执行时记录错误并返回0，其他失败返回-errno
+static int service_start(service_t *service) {
+    char msg[PATH_MAX + 64];
+    if (cgroup_create(&service->cgroup, &service->opt.cgroup, service->name, msg, sizeof(msg)) < 0 || msg[0]) {
+        log_write(LOG_TYPE_PROCESS, getpid(), service->path, service->name, msg);
+    }
+
+    int pipes[3][2]; // 子进程的stdin/stdout/stderr
+    if (process_stdio(pipes, 3, service->opt.pty) < 0) {
+        cgroup_destroy(&service->cgroup);
+        return -errno;
+    }
+
+    // 以vfork方式创建子进程：不复制监管进程的页表，子进程exec后监管进程才继续，同时得到pidfd。
+    // 屏蔽所有信号，避免子进程在exec前执行监管进程的信号处理函数
+    static char stack[SUPERVISOR_STACK_SIZE] __attribute__((aligned(16)));
+    sigset_t all, old;
+    sigfillset(&all);
+    sigprocmask(SIG_SETMASK, &all, &old);
+
+    service_spawn_t spawn = {&service->cred, service->groups, service->group_count, service->cwd, service->argv, service->envp, {pipes[0][0], pipes[1][1], pipes[2][1]}, &service->cgroup, &service->opt.sched, &old, 0};
+    char **saved_environ  = environ;
+    int pidfd             = -1;
+    pid_t pid = clone(service_child, stack + sizeof(stack), CLONE_VM | CLONE_VFORK | CLONE_PIDFD | SIGCHLD, &spawn, &pidfd);
+    int err   = errno;
+
+    environ = saved_environ;
+    sigprocmask(SIG_SETMASK, &old, NULL);
+
+    close(pipes[0][0]);
+    close(pipes[1][1]);
+    close(pipes[2][1]);
+
+    if (pid < 0 || spawn.error != 0) {
+        if (pipes[0][1] >= 0) {
+            close(pipes[0][1]);
+        }
+        close(pipes[1][0]);
+        close(pipes[2][0]);
+        if (pid < 0) {
+            cgroup_destroy(&service->cgroup);
+            return -err;
+        }
+
+        // 命令无法执行时与process_run一样只记录错误，不让客户端再自行启动一次
+        log_write(LOG_TYPE_PROCESS, pid, service->path, service->name, strerror(spawn.error));
+        waitpid(pid, NULL, 0);
+        close(pidfd);
+        cgroup_destroy(&service->cgroup);
+        return 0;
+    }
+
+    if (capture_open(&service->capture, pid, service->path, service->name, pipes[1][0], pipes[2][0], service->opt.pty) < 0) {
+        log_write(LOG_TYPE_PROCESS, pid, service->path, service->name, "no memory!");
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+        if (pipes[0][1] >= 0) {
+            close(pipes[0][1]);
+        }
+        close(pipes[1][0]);
+        close(pipes[2][0]);
+        close(pidfd);
+        cgroup_destroy(&service->cgroup);
+        return -ENOMEM;
+    }
+
+    service->pid        = pid;
+    service->pidfd      = pidfd;
+    service->stdin_fd   = pipes[0][1];
+    service->exited     = 0;
+    service->reap_error = 0;
+    service->start      = service_now();
+    service->start_us   = now_us();
+    service->restart_at = -1;
+    service_table_set(service->entry, SERVICE_STATE_RUNNING, pid, service->restart.count, 0);
+
+    log_write(LOG_TYPE_PROCESS, pid, service->path, service->name, "start!");
+
+    service->capture.epfd = supervisor_epfd;
+    for (int i = 0; i < CAPTURE_STREAMS; i++) {
+        if (service->capture.streams[i].fd >= 0) {
+            service_watch(service, service->capture.streams[i].fd, i);
+        }
+    }
+
+    // pidfd无法加入epoll时在输出关闭后阻塞等待，与原先每个程序一个监视进程的行为一致
+    if (service->pidfd < 0 || service_watch(service, service->pidfd, CAPTURE_STREAMS) < 0) {
+        log_write(LOG_TYPE_PROCESS, pid, service->path, service->name, strerror(errno));
+    }
+    return pid;
+}
+
+// 解析启动请求（buffer由service接管），返回回复给客户端的值
+// 请求方的附加组：优先取连接对端进程当前的组（SO_PEERGROUPS），与其自行启动时继承的一致；
+// 内核不支持时按用户名从组数据库解析，仍失败时只保留主组
+static gid_t *peer_groups(int conn, const struct ucred *cred, int *count) {
+    socklen_t len = SUPERVISOR_GROUPS * sizeof(gid_t);
+    gid_t *groups = malloc(len);
+    if (!groups) {
+        return NULL;
+    }
+
+#ifdef SO_PEERGROUPS
+    int ret = getsockopt(conn, SOL_SOCKET, SO_PEERGROUPS, groups, &len);
+    if (ret < 0 && errno == ERANGE) {
+        gid_t *larger = realloc(groups, len);
+        if (!larger) {
+            free(groups);
+            return NULL;
+        }
+        groups = larger;
+        ret    = getsockopt(conn, SOL_SOCKET, SO_PEERGROUPS, groups, &len);
+    }
+    if (ret == 0) {
+        *count = len / sizeof(gid_t);
+        return groups;
+    }
+#endif
+
+    struct passwd *pw = getpwuid(cred->uid);
+    int n             = SUPERVISOR_GROUPS;
+    if (pw && getgrouplist(pw->pw_name, cred->gid, groups, &n) < 0) {
+        gid_t *larger = realloc(groups, n * sizeof(gid_t));
+        if (!larger) {
+            free(groups);
+            return NULL;
+        }
+        groups = larger;
+        if (getgrouplist(pw->pw_name, cred->gid, groups, &n) < 0) {
+            pw = NULL;
+        }
+    }
+    if (!pw) {
+        groups[0] = cred->gid;
+        n         = 1;
+    }
+    *count = n;
+    return groups;
+}
+
+static int32_t supervisor_handle(char *buffer, size_t size, int conn, const struct ucred *cred) {
+    supervisor_head_t head;
+    if (size < sizeof(head)) {
+        return -EINVAL;
+    }
+    memcpy(&head, buffer, sizeof(head));
+
+    // 以root运行时才能以其他用户的身份启动程序
+    if (geteuid() != 0 && cred->uid != geteuid()) {
+        return -EPERM;
+    }
+
+    size_t count = 2 + (size_t)head.argc + head.envc;
+    if (head.argc == 0 || count > size) {
+        return -EINVAL;
+    }
+
+    service_t *service = calloc(1, sizeof(service_t));
+    if (!service) {
+        return -ENOMEM;
+    }
+    service->request = malloc(size);
+    service->strings = malloc((count + 2) * sizeof(char *));
+    if (!service->request || !service->strings) {
+        service_free(service);
+        return -ENOMEM;
+    }
+    memcpy(service->request, buffer, size);
+
+    char *p   = service->request + sizeof(head);
+    char *end = service->request + size;
+    for (size_t i = 0; i < count; i++) {
+        char *nul = memchr(p, '\0', end - p);
+        if (!nul) {
+            service_free(service);
+            return -EINVAL;
+        }
+        service->strings[i] = p;
+        p                   = nul + 1;
+    }
+
+    // strings: cwd, options, argv..., NULL, envp..., NULL
+    char **strings = service->strings;
+    char **argv    = strings + 2;
+    memmove(argv + head.argc + 1, argv + head.argc, head.envc * sizeof(char *));
+    argv[head.argc] = NULL;
+    char **envp     = argv + head.argc + 1;
+    envp[head.envc] = NULL;
+
+    service->cred       = *cred;
+    service->groups     = peer_groups(conn, cred, &service->group_count);
+    if (!service->groups) {
+        service_free(service);
+        return -ENOMEM;
+    }
+    service->cwd        = strings[0];
+    service->argv       = argv;
+    service->envp       = envp;
+    service->restart_at = -1;
+
+    service_opt_init(&service->opt);
+    service_opt_parse(&service->opt, strings[1]);
+
+    service->path    = strdup(argv[0]);
+    char *path_clone = strdup(argv[0]);
+    if (!service->path || !path_clone) {
+        free(path_clone);
+        service_free(service);
+        return -ENOMEM;
+    }
+    service->name = strdup(basename(path_clone));
+    free(path_clone);
+    if (!service->name) {
+        service_free(service);
+        return -ENOMEM;
+    }
+
+    // cgroup在切换身份之前以监管进程的身份创建和加入，只接受与监管进程同一用户（以root运行时即root）的请求中的cgroup选项，
+    // 否则普通用户可以在root管理的层级中给自己更高的权重或解除限制
+    if (cred->uid != geteuid() && cgroup_limits_used(&service->opt.cgroup)) {
+        memset(&service->opt.cgroup, 0, sizeof(service->opt.cgroup));
+        log_write(LOG_TYPE_PROCESS, getpid(), service->path, service->name, "cgroup options ignored: requester is not root");
+    }
+
+    service->entry = service_table_claim(service->path, service->name);
+
+    int32_t ret = service_start(service);
+    if (ret <= 0) {
+        service_table_release(service->entry, SERVICE_STATE_EXITED, 0);
+        service_free(service);
+        return ret;
+    }
+
+    service->next = services;
+    services      = service;
+    return ret;
+}
+
+static void supervisor_accept(int ctl_fd) {
+    static char buffer[SUPERVISOR_REQUEST_MAX];
+
+    int conn = accept4(ctl_fd, NULL, NULL, SOCK_CLOEXEC);
+    if (conn < 0) {
+        return;
+    }
+
+    struct timeval tv = {SUPERVISOR_RECV_TIMEOUT, 0};
+    setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    struct ucred cred;
+    socklen_t cred_len = sizeof(cred);
+    int32_t reply      = -EINVAL;
+
+    ssize_t size = recv(conn, buffer, sizeof(buffer), MSG_TRUNC);
+    if (size > (ssize_t)sizeof(buffer)) {
+        reply = -E2BIG;
+    } else if (size > 0 && getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) == 0) {
+        reply = supervisor_handle(buffer, size, conn, &cred);
+    }
+
+    send(conn, &reply, sizeof(reply), MSG_NOSIGNAL);
+    close(conn);
+}
+
+// 回收已退出的子进程；wait4失败（不会再得到退出状态）时同样视为已退出，记录原因
+static void service_reap(service_t *service, int block) {
+    pid_t ret;
+    while ((ret = wait4(service->pid, &service->status, block ? 0 : WNOHANG, &service->usage)) < 0 && errno == EINTR) {
+    }
+    if (ret == service->pid || ret < 0) {
+        service->exited     = 1;
+        service->reap_error = (ret < 0) ? errno : 0;
+        service->exit_us    = now_us();
+    }
+}
+
+// 子进程已退出且输出管道都已关闭时写出退出记录，按重启策略安排重启；到时间后重启。
+// 不再需要该服务时返回1，由调用者释放
+static int service_update(service_t *service) {
+    char msg[512];
+
+    if (service->restart_at >= 0) {
+        // 等待重启期间也处理se-boot stop/restart的请求
+        int request = service_table_request(service->entry);
+        if (request == SERVICE_REQUEST_STOP) {
+            log_write(LOG_TYPE_PROCESS, service->pid, service->path, service->name, "stopped!");
+            service_table_release(service->entry, SERVICE_STATE_STOPPED, service->status);
+            return 1;
+        }
+        if (request != SERVICE_REQUEST_RESTART && service_now() < service->restart_at) {
+            return 0;
+        }
+        if (service_start(service) <= 0) {
+            service_table_release(service->entry, SERVICE_STATE_EXITED, service->status);
+            return 1;
+        }
+
+        // 从发现退出到新的子进程开始运行的耗时，含退避等待
+        snprintf(msg, sizeof(msg), "restart #%d: recovered in %.3f ms (backoff %ld ms)", service->restart.count,
+                 (now_us() - service->exit_us) / 1000.0, service->delay);
+        log_write(LOG_TYPE_PROCESS, service->pid, service->path, service->name, msg);
+        return 0;
+    }
+
+    if (!service->exited || service->capture.open_count > 0) {
+        // 有丢弃的行时按时汇总
+        if (capture_timeout(&service->capture) == 0) {
+            capture_report(&service->capture, 0);
+        }
+        return 0;
+    }
+
+    capture_close(&service->capture);
+
+    // 无法取得退出状态时不写退出记录，也不按重启策略重启
+    if (service->reap_error) {
+        log_write(LOG_TYPE_PROCESS, service->pid, service->path, service->name, strerror(service->reap_error));
+        cgroup_destroy(&service->cgroup);
+        if (service->stdin_fd >= 0) {
+            close(service->stdin_fd);
+        }
+        if (service->pidfd >= 0) {
+            close(service->pidfd);
+            service->pidfd = -1;
+        }
+        service_table_release(service->entry, SERVICE_STATE_EXITED, 0);
+        return 1;
+    }
+
+    // 退出记录：退出码或信号、耗时与资源用量；使用cgroup时再附上本次运行的memory.peak与cpu.stat
+    char exit_stats[192];
+    char stats[256];
+    process_exit_stats(service->status, service->exit_us - service->start_us, &service->usage, exit_stats,
+                       sizeof(exit_stats));
+    cgroup_stats(&service->cgroup, stats, sizeof(stats));
+    cgroup_destroy(&service->cgroup);
+    snprintf(msg, sizeof(msg), "exit!%s%s", exit_stats, stats);
+    log_write(LOG_TYPE_PROCESS, service->pid, service->path, service->name, msg);
+
+    if (service->stdin_fd >= 0) {
+        close(service->stdin_fd);
+    }
+    if (service->pidfd >= 0) {
+        close(service->pidfd);
+        service->pidfd = -1;
+    }
+
+    // se-boot stop/restart的请求优先于重启策略
+    int request = service_table_request(service->entry);
+    if (request == SERVICE_REQUEST_STOP) {
+        log_write(LOG_TYPE_PROCESS, service->pid, service->path, service->name, "stopped!");
+        service_table_release(service->entry, SERVICE_STATE_STOPPED, service->status);
+        return 1;
+    }
+    if (request == SERVICE_REQUEST_RESTART) {
+        service->restart.count++;
+        service->delay = 0;
+        log_write(LOG_TYPE_PROCESS, service->pid, service->path, service->name, "restart requested");
+    } else {
+        long ran       = service_now() - service->start;
+        service->delay = service_restart_next(&service->opt, &service->restart, service->status, ran, msg, sizeof(msg));
+        if (msg[0]) {
+            log_write(LOG_TYPE_PROCESS, service->pid, service->path, service->name, msg);
+        }
+        if (service->delay < 0) {
+            service_table_release(service->entry, SERVICE_STATE_EXITED, service->status);
+            return 1;
+        }
+    }
+
+    service_table_set(service->entry, SERVICE_STATE_BACKOFF, service->pid, service->restart.count, service->status);
+    service->restart_at = service_now() + service->delay;
+    return 0;
+}
+
+static int supervisor_timeout() {
+    int timeout = -1;
+    long now    = service_now();
+    for (service_t *service = services; service; service = service->next) {
+        int t;
+        if (service->restart_at >= 0) {
+            t = (service->restart_at > now) ? (int)(service->restart_at - now) : 0;
+            // 定期检查等待期间的stop/restart请求
+            if (service->entry && t > SERVICE_TABLE_POLL_MS) {
+                t = SERVICE_TABLE_POLL_MS;
+            }
+        } else {
+            t = capture_timeout(&service->capture);
+        }
+        if (t >= 0 && (timeout < 0 || t < timeout)) {
+            timeout = t;
+        }
+    }
+    return timeout;
+}
+
+// 收到终止信号时删除控制套接字，之后的se-boot <command>回退为自行启动
+static void supervisor_stop(int sig) {
+    (void)sig;
+    unlink(SE_CTL_SOCK);
+    _exit(0);
+}
+
+// 监管进程主循环：通过一个epoll等待控制套接字、所有后台程序的输出管道与pidfd
+void supervisor_run(int ctl_fd) {
+    // 与process_run一致，保证日志文件对所有用户可写
+    umask(0);
+
+    supervisor_epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (supervisor_epfd < 0) {
+        log_write(LOG_TYPE_BOOT, getpid(), "/", "se-boot", strerror(errno));
+        unlink(SE_CTL_SOCK);
+        return;
+    }
+
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = NULL};
+    epoll_ctl(supervisor_epfd, EPOLL_CTL_ADD, ctl_fd, &event);
+
+    signal(SIGTERM, supervisor_stop);
+    signal(SIGINT, supervisor_stop);
+
+    struct epoll_event events[SUPERVISOR_EVENTS];
+    while (1) {
+        int n = epoll_wait(supervisor_epfd, events, SUPERVISOR_EVENTS, supervisor_timeout());
+        if (n < 0 && errno != EINTR) {
+            log_write(LOG_TYPE_BOOT, getpid(), "/", "se-boot", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            service_watch_t *watch = events[i].data.ptr;
+            if (!watch) {
+                supervisor_accept(ctl_fd);
+            } else if (watch->index < CAPTURE_STREAMS) {
+                capture_read(&watch->service->capture, watch->index);
+            } else {
+                service_reap(watch->service, 0);
+                if (watch->service->exited) {
+                    epoll_ctl(supervisor_epfd, EPOLL_CTL_DEL, watch->service->pidfd, NULL);
+                    close(watch->service->pidfd);
+                    watch->service->pidfd = -1;
+                }
+            }
+        }
+
+        // 事件处理完后再释放，避免同一批事件中引用已释放的服务
+        service_t **link = &services;
+        while (*link) {
+            service_t *service = *link;
+            if (service->restart_at < 0 && service->pidfd < 0 && !service->exited && service->capture.open_count == 0) {
+                service_reap(service, 1);
+            }
+            service_t *next = service->next;
+            if (service_update(service)) {
+                *link = next;
+            } else {
+                link = &service->next;
+            }
+        }
+    }
+
+    unlink(SE_CTL_SOCK);
+    close(supervisor_epfd);
+}
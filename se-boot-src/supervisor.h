@@ -0,0 +1,21 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SE_BOOT_SUPERVISOR_H
+#define SE_BOOT_SUPERVISOR_H
+
+#include "se-boot-src/service.h"
+
+#define SUPERVISOR_REQUEST_MAX (128 * 1024) // 单个启动请求（工作目录、参数、环境变量）的上限
+
+int supervisor_enabled();
+int supervisor_open();
+void supervisor_run(int ctl_fd);
+int supervisor_request(const char **argv, const service_opt_t *opt);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif